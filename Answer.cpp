@@ -18,12 +18,186 @@ namespace {
 }
 
 namespace hpc {
-    int prevLotus;
-    float baseAccelTiming;
-    float accelTTL;
-    int lotusLen;
-    Vec2 flow;
-    Vec2 lotusTargetPos[1000];
+    // 惰性移動の表
+    // 加速直後の速さは常に CharaAccelSpeed で、毎ターン CharaDecelSpeed ずつ減るので、
+    // 加速してからのターン数 k だけで速さと止まるまでの移動量が決まる。
+    const int CoastTableSize = 64;
+
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // 先読みプランナー
+    //
+    // 加速するタイミングと方向の候補を Chara::move と同じ規則で数手先までシミュレートし、
+    // 次の PlanLotusCounts 個の蓮を最も少ないターン数で通過できる加速列を選ぶ。
+    // 候補の加速列を実行した後は decideAccel の判定で進めて評価する。
+    // 他のキャラとの衝突は考慮しないので、予測した位置からずれたら計画を立て直す。
+    //
+    // 計画を立てたターンには段階 (レベル) 0 の探索を必ず行い、
+    // 評価する蓮の数を増やした次の段階の探索を始める (反復深化) 。
+    // 探索は PlanSearch に途中経過を残して 1 ターンに PlanWorkPerTurn 個の候補を調べたら中断し、
+    // 計画どおりに進んでいる間は次のターンに続きから再開する。
+    // 時計ではなく調べた候補の数で区切るので、実行環境や並列数によらず同じ結果になる。
+    // TimeBudget は、制限時間の予備に入った場合に探索をやめる安全策としてだけ使う。
+    // TimeBudget の締め切りが有効な場合は、候補の数の代わりに TimeBudget::isTurnInTime で区切る。
+    // 締め切りまでに探索し終えなかった段階は次のターンに続け、それまでは探索し終えた段階の計画を使う。
+    // 評価する蓮を 4 個以上にした段階を締め切りまで深めると、かえって遅くなったので、段階の数は変えない。
+    // 探索し終えたら、実行済みのターンと矛盾しない場合に限り計画を置き換える。
+    // 加速の回数を増やす方向に深くすると、衝突を考慮しないモデルに合わせ込んでしまい
+    // かえって遅くなったので、深さは PlanDepth で固定している。
+    //
+    // 敵キャラとの衝突は predictEnemies で予測し、計画を立てたターンから
+    // PlanCollisionTurn ターン以内に敵キャラとぶつかる候補には PlanCollisionCost を加える。
+
+    const int PlanDepth = 1;                // 明示的に候補を列挙する加速の回数
+    const int PlanWorkPerTurn = 8;         // 1 ターンに調べる次の段階の候補の数
+    const int PlanLevelCount = 2;           // 探索の段階の数
+    const int PlanLotusCounts[PlanLevelCount] = { 2, 3 };   // 各段階で何個先の蓮までを評価するか
+    const int PlanHorizon = 200;            // 1 回のシミュレーションで進める最大ターン数
+    const int PlanWaitCount = 4;
+    const int PlanWaits[PlanWaitCount] = { 0, 3, 6, 10 };   // 加速までに待つターン数の候補
+    const int PlanAimCount = 5;             // 加速方向の候補数 (planAim 参照)
+    const int PlanCommitTurnMax = 16;       // 1 回の計画で確定させる最大ターン数
+    const float PlanAccelValue = 3.0f;      // 残り加速回数 1 回あたりの価値 (ターン換算)
+    const int PlanCollisionTurn = 16;       // 敵キャラとの衝突を予測するターン数
+    const float PlanCollisionCost = 1.5f;   // 敵キャラとぶつかる候補に加える評価値 (ターン換算)
+
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // 敵キャラの軌跡の予測
+    //
+    // 計画を立てたターンに、各敵キャラが加速せずに惰性で進む軌跡と、
+    // CPU の方針に従って目指す蓮へ加速する軌跡の期待値を PlanCollisionTurn ターン先まで求めておく。
+    // CPU は加速できる場合、 CpuSaveAccelRate % の確率で加速を節約して待ち、
+    // CpuSaveAccelTurnMax ターン続けて節約した後は必ず加速する。
+    // 加速の向きは目指す蓮から左右に均等にぶれるので、ぶれのない向きへ加速するものとする。
+    // 敵キャラはすべて CPU とし、敵キャラ同士の衝突は考慮しない。
+    //
+    // CPU が節約して待ったターン数と、強さによって短くなる加速回数が増えるまでのターン数は
+    // StageAccessor から直接は分からないので、 observeCpus で毎ターンの変化から求める。
+    // 加速できる回数が減ったターンは加速し、減らなかったターンは節約したものとする。
+
+    const int EnemyCountMax = Parameter::CharaCountMax - 1;
+    const int EnemyTrackCountMax = EnemyCountMax * 2;   // 予測する軌跡の最大数
+    const int CpuSaveAccelRate = 40;        // CPU が加速を節約する確率 (%)
+    const int CpuSaveAccelTurnMax = 2;      // CPU が続けて加速を節約する最大ターン数
+    const int CpuSaveStateCount = CpuSaveAccelTurnMax + 1;
+
+    /// 先読み中のプレイヤーの状態
+    struct PlanState {
+        Vec2 pos;
+        Vec2 vel;
+        int accelCount;
+        int accelWaitTurn;
+        int targetLotusNo;
+        int prevLotusNo;                    // 前のターンに目指していた蓮 (prevLotus と同じ)
+        int passedCount;                    // 先読み開始から通過した蓮の数
+        int turn;                           // 先読み開始からの経過ターン数
+        bool isHit;                         // 敵キャラとぶつかると予測されたか
+    };
+
+    /// 計画の最初の加速
+    struct PlanChoice {
+        bool isDefault;                     // decideAccel の判定に従うか
+        int wait;                           // 加速までに待つターン数
+        Vec2 aimPos;                        // 加速の目標座標
+    };
+
+    /// 何ターンかに分けて進める探索の途中経過
+    struct PlanSearch {
+        PlanState root;                     // 探索を始めた状態
+        int goalCount;                      // 通過を目指す蓮の数
+        int waitIndex;                      // 次に調べる待ち時間の候補
+        int aimIndex;                       // 次に調べる加速方向の候補
+        PlanState waited;                   // root から PlanWaits[waitIndex] ターン待った状態
+        float bestCost;                     // 調べた候補の最小の評価値
+        PlanChoice bestChoice;              // 評価値が最小の候補
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // 1 つのゲームで使う状態
+    //
+    // ステージをまたいで使う状態をすべてこのクラスに持ち、 StageAccessor::answerState() の
+    // 領域に置くので、ゲームごとに別の状態になる。領域はゼロで初期化されているだけなので、
+    // コンストラクタやポインタを持つメンバは置かず、メンバはすべて init で設定する。
+
+    class Solver {
+    public:
+        void init(const StageAccessor& aStageAccessor);
+        Action getNextAction(const StageAccessor& aStageAccessor);
+
+    private:
+        int prevLotus;
+        float baseAccelTiming;
+        float accelTTL;
+        int lotusLen;
+        Vec2 flow;
+        Vec2 lotusTargetPos[Parameter::LotusCountMax];
+
+        // 惰性移動の表
+        int coastTableLen;                      // 速さが 0 になるまでのターン数 + 1
+        float coastSpeed[CoastTableSize];       // k ターン後の速さ
+        float coastDist[CoastTableSize];        // 速さ coastSpeed[k] から止まるまでの移動量 (流れを除く)
+        int coastTurn[CoastTableSize];          // 速さ coastSpeed[k] から止まるまでのターン数
+
+        // 先読みプランナー
+        Rectangle fieldRect;
+        Vec2 lotusPos[Parameter::LotusCountMax];
+        float lotusRadius[Parameter::LotusCountMax];
+        int planGoalCount;                      // 先読みで通過を目指す蓮の数
+        int planLevel;                          // 現在の計画を探索し終えた段階
+        PlanState planRoot;                     // 計画を立てたターンの状態
+        int planRestLotusCount;                 // 計画を立てたターンに残っていた通過すべき蓮の数
+        PlanSearch planSearch;                  // 次の段階の探索
+        bool planSearching;                     // planSearch が途中か
+        int planWork;                           // このターンに調べられる残りの候補の数
+
+        int planStartTurn;                      // 計画を立てたターン
+        int planLength;                         // 確定させたターン数
+        Vec2 planPath[PlanCommitTurnMax];       // 各ターンの開始時に予想される位置
+        bool planUseAccel[PlanCommitTurnMax];   // 各ターンで加速するか
+        Vec2 planAimPos[PlanCommitTurnMax];     // 各ターンの加速の目標座標
+
+        // 敵キャラの軌跡の予測
+        int cpuAccelCount[EnemyCountMax];       // 前のターンの加速できる回数
+        int cpuAccelWaitTurn[EnemyCountMax];    // 前のターンの加速回数が増えるまでの残りターン数
+        int cpuAccelWaitTurnMax[EnemyCountMax]; // 加速回数が増えるまでのターン数
+        int cpuSaveAccelTurn[EnemyCountMax];    // 加速を節約して待ったターン数
+        int enemyTrackCount;                    // 予測した軌跡の数
+        Vec2 enemyTrackPos[EnemyTrackCountMax][PlanCollisionTurn + 1];  // 各軌跡の、各ターンの移動後の位置
+
+        Vec2 getNextPosition(Vec2 pos, Vec2 vel, bool useAccel, Vec2 targetPos);
+        bool lookupCoast(float speed, float* dist, int* turn);
+        Vec2 lastPos(Vec2 pos, Vec2 vel);
+        void setCoastTable();
+        void setAccelTTL();
+        bool gettingCloser(Vec2 pos, Vec2 vel, Circle lotus);
+        Vec2 getTargetPos(Vec2 pos, Circle c1, int i);
+        void setLotusTargetPos(const StageAccessor& aStageAccessor);
+
+        Circle lotusRegion(int i);
+        void moveChara(Vec2& pos, Vec2& vel);
+        void addEnemyTrack(Vec2 pos, Vec2 vel);
+        void addCpuTrack(const Chara& enemy, int enemyNo);
+        void resetCpus(const StageAccessor& aStageAccessor);
+        void observeCpus(const StageAccessor& aStageAccessor);
+        void predictEnemies(const StageAccessor& aStageAccessor);
+        bool isEnemyHit(Vec2 pos, int turn);
+        bool decideAccel(Vec2 pos, Vec2 vel, int accelCount, int targetLotusNo, int prevLotusNo, Vec2* aimPos);
+        void stepPlan(PlanState& s, bool useAccel, Vec2 aimPos);
+        bool stepDefault(PlanState& s, Vec2* aimPos);
+        bool isPlanDone(const PlanState& s);
+        Vec2 planAim(const PlanState& s, int aimKind);
+        float rolloutPlan(PlanState s);
+        float searchPlan(const PlanState& aState, int depth);
+        void beginSearch(PlanSearch& search, const PlanState& root, int restLotusCount, int level);
+        bool hasPlanWork(const TimeBudget& budget);
+        bool resumeSearch(PlanSearch& search, const TimeBudget* budget);
+        PlanState startPlanState(const Chara& player);
+        int firstAccelTurn(PlanState s, const PlanChoice& choice);
+        void commitPlan(PlanState s, const PlanChoice& choice, int startTurn);
+        bool deepenPlan(const Chara& player, const TimeBudget& budget);
+        void makePlan(const StageAccessor& aStageAccessor, const TimeBudget& budget);
+        bool followPlan(const Chara& player, Action* action);
+    };
+
     
     Vec2 decel(Vec2 vel) {
         if (vel.length() <= Parameter::CharaDecelSpeed()) {
@@ -41,7 +215,48 @@ namespace hpc {
         return toPos;
     }
     
-    Vec2 lastPos(Vec2 pos, Vec2 vel) {
+    void Solver::setCoastTable() {
+        coastTableLen = 0;
+        float s = Parameter::CharaAccelSpeed();
+        while (coastTableLen < CoastTableSize) {
+            coastSpeed[coastTableLen++] = s;
+            if (s <= 0) {
+                break;
+            }
+            s = Math::Max(s - Parameter::CharaDecelSpeed(), 0.0f);
+        }
+        // 後ろから積み上げる (lastPos と同じく、減速してから移動する)
+        coastDist[coastTableLen - 1] = 0;
+        coastTurn[coastTableLen - 1] = 0;
+        for (int k = coastTableLen - 2; k >= 0; k--) {
+            coastDist[k] = coastSpeed[k + 1] + coastDist[k + 1];
+            coastTurn[k] = 1 + coastTurn[k + 1];
+        }
+    }
+
+    /// 速さ speed から止まるまでの移動量とターン数を表から求めます。
+    /// 表の間の速さでは、止まるまでのターン数が変わらず移動量は速さの一次式になるので、
+    /// 線形補間した値がループで求めた値と一致します。
+    /// @return 表の範囲外の速さの場合は false 。
+    bool Solver::lookupCoast(float speed, float* dist, int* turn) {
+        const float f = (Parameter::CharaAccelSpeed() - speed) / Parameter::CharaDecelSpeed();
+        if (f < 0 || coastTableLen - 1 <= f) {
+            return false;
+        }
+        const int k = static_cast<int>(f);
+        const float t = f - k;
+        *dist = coastDist[k] + (coastDist[k + 1] + coastSpeed[k + 1] - coastDist[k]) * t;
+        *turn = coastTurn[k];
+        return true;
+    }
+
+    Vec2 Solver::lastPos(Vec2 pos, Vec2 vel) {
+        const float speed = vel.length();
+        float dist = 0;
+        int turn = 0;
+        if (0 < speed && lookupCoast(speed, &dist, &turn)) {
+            return pos + vel * (dist / speed) + flow * static_cast<float>(turn);
+        }
         while (vel.length() > 0) {
             vel = decel(vel);
             pos += vel + flow;
@@ -49,7 +264,7 @@ namespace hpc {
         return pos;
     }
     
-    Vec2 getNextPosition(Vec2 pos, Vec2 vel, bool useAccel, Vec2 targetPos) {
+    Vec2 Solver::getNextPosition(Vec2 pos, Vec2 vel, bool useAccel, Vec2 targetPos) {
         if (useAccel) {
             vel = nomarizeVel(pos, targetPos);
         } else {
@@ -64,36 +279,34 @@ namespace hpc {
     
    
     // 1アクセルで何ターン生き延びるか
-    void setAccelTTL() {
-        float s = Parameter::CharaAccelSpeed();
+    void Solver::setAccelTTL() {
         accelTTL = 0;
-        while (s >= baseAccelTiming) {
-            s -= Parameter::CharaDecelSpeed();
+        while (accelTTL < coastTableLen && coastSpeed[static_cast<int>(accelTTL)] >= baseAccelTiming) {
             accelTTL += 1;
         }
     }
     
     
     ///今のままのベクトルでも、次の蓮に近づくかどうか
-    bool gettingCloser(Chara player, Circle lotus) {
-        Vec2 nextPos = getNextPosition(player.pos(), player.vel(), false, Vec2(0, 0));
+    bool Solver::gettingCloser(Vec2 pos, Vec2 vel, Circle lotus) {
+        Vec2 nextPos = getNextPosition(pos, vel, false, Vec2(0, 0));
 
-        Vec2 currentVec = lotus.pos() - player.pos();
+        Vec2 currentVec = lotus.pos() - pos;
         Vec2 nextVec = lotus.pos() - nextPos;
-        return (currentVec.length() - nextVec.length()) / player.vel().length() > 0.7;
+        return (currentVec.length() - nextVec.length()) / vel.length() > 0.7;
     }
     
-    Vec2 getTargetPos(Chara player, Circle c1, int i) {
+    Vec2 Solver::getTargetPos(Vec2 pos, Circle c1, int i) {
         Vec2 v1 = lotusTargetPos[i % lotusLen];
         Vec2 v2 = lotusTargetPos[(i + 1) % lotusLen];
 
-        if (Collision::IsHit(c1, player.region(), v2)) { // 2つめのに行くと1つ目に当たるなら2つ目のに向かう
-            Vec2 vel = (v2 - player.pos()).getNormalized(Parameter::CharaAccelSpeed()) - flow;
-            return player.pos() + vel * Parameter::CharaAddAccelWaitTurn;
+        if (Collision::IsHit(c1, Circle(pos, Parameter::CharaRadius()), v2)) { // 2つめのに行くと1つ目に当たるなら2つ目のに向かう
+            Vec2 vel = (v2 - pos).getNormalized(Parameter::CharaAccelSpeed()) - flow;
+            return pos + vel * Parameter::CharaAddAccelWaitTurn;
         }
         
-        Vec2 vel = (v1 - player.pos()).getNormalized(Parameter::CharaAccelSpeed()) - flow;
-        return player.pos() + vel * Parameter::CharaAddAccelWaitTurn;
+        Vec2 vel = (v1 - pos).getNormalized(Parameter::CharaAccelSpeed()) - flow;
+        return pos + vel * Parameter::CharaAddAccelWaitTurn;
     }
     
     Vec2 getCenterLotusPos(const Chara player, const Vec2 p1, const Circle c2, const Vec2 p3) {
@@ -117,7 +330,7 @@ namespace hpc {
     }
     
     
-    void setLotusTargetPos(const StageAccessor& aStageAccessor){
+    void Solver::setLotusTargetPos(const StageAccessor& aStageAccessor){
         const LotusCollection& lotuses = aStageAccessor.lotuses();
         Chara player = aStageAccessor.player();
         
@@ -146,60 +359,546 @@ namespace hpc {
     }
     
     ///////////////////////////////////////////////////////////////////////////////////////
-    
+    // 先読みプランナーの実装
 
-    /// 各ステージ開始時に呼び出されます。
-    /// この関数を実装することで、各ステージに対して初期処理を行うことができます。
-    /// @param[in] aStageAccessor 現在のステージ。
-    void Answer::Init(const StageAccessor& aStageAccessor) {
+    Circle Solver::lotusRegion(int i) {
+        return Circle(lotusPos[i], lotusRadius[i]);
+    }
+
+    /// 1 手先の判定で加速するかを決めます。
+    bool Solver::decideAccel(Vec2 pos, Vec2 vel, int accelCount, int targetLotusNo, int prevLotusNo, Vec2* aimPos) {
+        const Circle region(pos, Parameter::CharaRadius());
+        const Circle targetLotus = lotusRegion(targetLotusNo);
+
+        bool isAccel = false;
+        if (Collision::IsHit(lotusRegion(prevLotusNo), region)){
+            isAccel = !gettingCloser(pos, vel, targetLotus);
+        } else {
+            isAccel = !Collision::IsHit(targetLotus, region, lastPos(pos, vel))
+            and vel.length() < baseAccelTiming;
+            if (isAccel) {
+                if (accelCount <= 1) {
+                    isAccel = false;
+                }
+            }
+        }
+
+        *aimPos = getTargetPos(pos, targetLotus, targetLotusNo);
+        return accelCount > 0 && isAccel;
+    }
+
+    /// 1 ターン分移動させ、フィールドの外に出た場合は内側に戻します。
+    /// 計算は Chara::move と Chara::correctInside と同じです。
+    void Solver::moveChara(Vec2& pos, Vec2& vel) {
+        pos += vel + flow;
+        if (!vel.isZero()) {
+            const float len = Math::Max(vel.length() - Parameter::CharaDecelSpeed(), 0.0f);
+            if (0.0f < len) {
+                vel.normalize(len);
+            } else {
+                vel.reset();
+            }
+        }
+
+        const float radius = Parameter::CharaRadius();
+        bool isCorrect = false;
+        if (pos.x - radius < fieldRect.left) {
+            pos.x = fieldRect.left + radius;
+            isCorrect = true;
+        } else if (fieldRect.right < pos.x + radius) {
+            pos.x = fieldRect.right - radius;
+            isCorrect = true;
+        }
+        if (pos.y - radius < fieldRect.bottom) {
+            pos.y = fieldRect.bottom + radius;
+            isCorrect = true;
+        } else if (fieldRect.top < pos.y + radius) {
+            pos.y = fieldRect.top - radius;
+            isCorrect = true;
+        }
+        if (isCorrect) {
+            vel.reset();
+        }
+    }
+
+    /// 1 ターン進めます。処理の順番と計算は Stage::runTurn と同じです。
+    void Solver::stepPlan(PlanState& s, bool useAccel, Vec2 aimPos) {
+        s.prevLotusNo = s.targetLotusNo;
+        if (useAccel && s.accelCount > 0) {
+            const Vec2 toAim = aimPos - s.pos;
+            if (!toAim.isZero()) {
+                --s.accelCount;
+                s.vel = toAim.getNormalized(Parameter::CharaAccelSpeed());
+            }
+        }
+
+        const Circle prevRegion(s.pos, Parameter::CharaRadius());
+        moveChara(s.pos, s.vel);
+
+        if (--s.accelWaitTurn <= 0) {
+            s.accelCount = Math::Min(s.accelCount + 1, Parameter::CharaAccelCountMax);
+            s.accelWaitTurn = Parameter::CharaAddAccelWaitTurn;
+        }
+
+        while (s.passedCount < planGoalCount
+               && Collision::IsHit(lotusRegion(s.targetLotusNo), prevRegion, s.pos)) {
+            ++s.passedCount;
+            s.targetLotusNo = (s.targetLotusNo + 1) % lotusLen;
+        }
+        ++s.turn;
+        if (!s.isHit && s.turn <= PlanCollisionTurn) {
+            s.isHit = isEnemyHit(s.pos, s.turn);
+        }
+    }
+
+    /// decideAccel の判定に従って 1 ターン進めます。
+    /// @return 加速した場合は true 。
+    bool Solver::stepDefault(PlanState& s, Vec2* aimPos) {
+        const bool useAccel = decideAccel(s.pos, s.vel, s.accelCount, s.targetLotusNo, s.prevLotusNo, aimPos);
+        stepPlan(s, useAccel, *aimPos);
+        return useAccel;
+    }
+
+    bool Solver::isPlanDone(const PlanState& s) {
+        return planGoalCount <= s.passedCount || PlanHorizon <= s.turn;
+    }
+
+    /// 加速方向の候補を目標座標として返します。
+    Vec2 Solver::planAim(const PlanState& s, int aimKind) {
+        const Vec2 v1 = lotusTargetPos[s.targetLotusNo];
+        const Vec2 v2 = lotusTargetPos[(s.targetLotusNo + 1) % lotusLen];
+        switch (aimKind) {
+        case 0: return v1;
+        case 1: return v2;
+        case 2: return lotusPos[s.targetLotusNo];
+        case 3: return s.pos + ((v1 - s.pos).getNormalized(Parameter::CharaAccelSpeed()) - flow) * Parameter::CharaAddAccelWaitTurn;
+        default: return s.pos + ((v2 - s.pos).getNormalized(Parameter::CharaAccelSpeed()) - flow) * Parameter::CharaAddAccelWaitTurn;
+        }
+    }
+
+    /// decideAccel の判定で最後まで進め、かかったターン数を評価値として返します。
+    float Solver::rolloutPlan(PlanState s) {
+        Vec2 aimPos;
+        while (!isPlanDone(s)) {
+            stepDefault(s, &aimPos);
+        }
+        float cost = static_cast<float>(s.turn) - PlanAccelValue * s.accelCount;
+        if (s.passedCount < planGoalCount) {
+            cost += s.pos.dist(lotusPos[s.targetLotusNo]) / Parameter::CharaAccelSpeed();
+        }
+        if (s.isHit) {
+            cost += PlanCollisionCost;
+        }
+        return cost;
+    }
+
+    /// 加速の候補を深さ優先で列挙し、最小の評価値を返します。
+    float Solver::searchPlan(const PlanState& aState, int depth) {
+        float bestCost = rolloutPlan(aState);
+        if (depth == PlanDepth || isPlanDone(aState)) {
+            return bestCost;
+        }
+
+        PlanState waited = aState;
+        for (int w = 0; w < PlanWaitCount; w++) {
+            while (waited.turn - aState.turn < PlanWaits[w] && !isPlanDone(waited)) {
+                stepPlan(waited, false, Vec2());
+            }
+            if (isPlanDone(waited)) {
+                break;
+            }
+            if (waited.accelCount <= 0) {
+                continue;
+            }
+            for (int k = 0; k < PlanAimCount; k++) {
+                PlanState s = waited;
+                stepPlan(s, true, planAim(s, k));
+                bestCost = Math::Min(bestCost, searchPlan(s, depth + 1));
+            }
+        }
+        return bestCost;
+    }
+
+    /// 状態 root から、段階 level の探索を始めます。
+    void Solver::beginSearch(PlanSearch& search, const PlanState& root, int restLotusCount, int level) {
+        search.root = root;
+        search.goalCount = Math::Min(PlanLotusCounts[level], restLotusCount);
+        search.waitIndex = 0;
+        search.aimIndex = 0;
+        search.waited = root;
+        planGoalCount = search.goalCount;
+        search.bestCost = rolloutPlan(root);
+        search.bestChoice.isDefault = true;
+    }
+
+    /// このターンにまだ候補を調べられるかを返します。
+    /// 制限時間の予備に入った場合は、候補が残っていても探索をやめます。
+    /// 締め切りが有効な場合は、締め切りまで調べます。
+    bool Solver::hasPlanWork(const TimeBudget& budget) {
+        if (budget.isDeadlineEnabled()) {
+            return budget.isTurnInTime();
+        }
+        return 0 < planWork && !budget.isInReserve();
+    }
+
+    /// 探索を続きから進めます。 budget を渡した場合は、このターンに調べられる候補を
+    /// 使い切ったら中断します。
+    /// @return 探索し終えた場合は true 。
+    bool Solver::resumeSearch(PlanSearch& search, const TimeBudget* budget) {
+        planGoalCount = search.goalCount;
+        for (; search.waitIndex < PlanWaitCount; search.waitIndex++, search.aimIndex = 0) {
+            PlanState& waited = search.waited;
+            while (waited.turn - search.root.turn < PlanWaits[search.waitIndex] && !isPlanDone(waited)) {
+                stepPlan(waited, false, Vec2());
+            }
+            if (isPlanDone(waited)) {
+                break;
+            }
+            if (waited.accelCount <= 0) {
+                continue;
+            }
+            for (; search.aimIndex < PlanAimCount; search.aimIndex++) {
+                if (budget) {
+                    if (!hasPlanWork(*budget)) {
+                        return false;
+                    }
+                    --planWork;
+                }
+                PlanState s = waited;
+                const Vec2 aimPos = planAim(s, search.aimIndex);
+                stepPlan(s, true, aimPos);
+                const float cost = searchPlan(s, 1);
+                if (cost < search.bestCost) {
+                    search.bestCost = cost;
+                    search.bestChoice.isDefault = false;
+                    search.bestChoice.wait = PlanWaits[search.waitIndex];
+                    search.bestChoice.aimPos = aimPos;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// 先読みの開始状態を現在のプレイヤーの状態に合わせます。
+    PlanState Solver::startPlanState(const Chara& player) {
+        PlanState s;
+        s.pos = player.pos();
+        s.vel = player.vel();
+        s.accelCount = player.accelCount();
+        s.accelWaitTurn = player.accelWaitTurn();
+        s.targetLotusNo = player.targetLotusNo();
+        s.prevLotusNo = prevLotus;
+        s.passedCount = 0;
+        s.turn = 0;
+        s.isHit = false;
+        return s;
+    }
+
+    /// choice に従って状態 s から進めたとき、最初に加速するターンを返します。
+    /// 計画で確定させる範囲で加速しない場合は PlanCommitTurnMax を返します。
+    int Solver::firstAccelTurn(PlanState s, const PlanChoice& choice) {
+        if (!choice.isDefault) {
+            return choice.wait;
+        }
+        for (int turn = 0; turn < PlanCommitTurnMax; turn++) {
+            Vec2 aimPos;
+            if (stepDefault(s, &aimPos)) {
+                return turn;
+            }
+        }
+        return PlanCommitTurnMax;
+    }
+
+    /// choice に従って、状態 s から最初の加速までを計画として確定させます。
+    void Solver::commitPlan(PlanState s, const PlanChoice& choice, int startTurn) {
+        planStartTurn = startTurn;
+        planLength = 0;
+        while (planLength < PlanCommitTurnMax) {
+            planPath[planLength] = s.pos;
+            bool useAccel = false;
+            if (choice.isDefault) {
+                useAccel = decideAccel(s.pos, s.vel, s.accelCount, s.targetLotusNo, s.prevLotusNo, &planAimPos[planLength]);
+            } else if (planLength == choice.wait) {
+                useAccel = true;
+                planAimPos[planLength] = choice.aimPos;
+            }
+            planUseAccel[planLength] = useAccel;
+            stepPlan(s, useAccel, planAimPos[planLength]);
+            ++planLength;
+            if (useAccel) {
+                break;
+            }
+        }
+    }
+
+    /// 候補を使い切るまで次の段階の探索を進め、探索し終えたらその結果で計画を置き換えます。
+    /// 計画どおりに進んでいて、計画を立ててから加速していない必要があります。
+    /// @return 計画を置き換えた場合は true 。
+    bool Solver::deepenPlan(const Chara& player, const TimeBudget& budget) {
+        bool isReplaced = false;
+        while (planLevel + 1 < PlanLevelCount && hasPlanWork(budget)) {
+            if (!planSearching) {
+                beginSearch(planSearch, planRoot, planRestLotusCount, planLevel + 1);
+                planSearching = true;
+            }
+            if (!resumeSearch(planSearch, &budget)) {
+                break;
+            }
+            planSearching = false;
+            ++planLevel;
+
+            // 実行済みのターンはすべて待っていたので、それより後に加速する場合だけ置き換えられる
+            const PlanChoice& choice = planSearch.bestChoice;
+            if (player.passedTurn() - planStartTurn <= firstAccelTurn(planRoot, choice)) {
+                commitPlan(planRoot, choice, planStartTurn);
+                isReplaced = true;
+            }
+        }
+        return isReplaced;
+    }
+
+    /// 現在の状態から計画を立て、最初の加速までを確定させます。
+    /// 段階 0 の探索は必ず行い、このターンに残っている候補の数だけ探索を深めます。
+    void Solver::makePlan(const StageAccessor& aStageAccessor, const TimeBudget& budget) {
+        const Chara& player = aStageAccessor.player();
+        predictEnemies(aStageAccessor);
+        planRoot = startPlanState(player);
+        planRestLotusCount = Parameter::StageRoundCount * lotusLen - player.passedLotusCount();
+        beginSearch(planSearch, planRoot, planRestLotusCount, 0);
+        resumeSearch(planSearch, 0);
+        commitPlan(planRoot, planSearch.bestChoice, player.passedTurn());
+        planLevel = 0;
+        planSearching = false;
+        deepenPlan(player, budget);
+    }
+
+    /// 加速せずに惰性で進む軌跡を予測して追加します。
+    void Solver::addEnemyTrack(Vec2 pos, Vec2 vel) {
+        Vec2* track = enemyTrackPos[enemyTrackCount++];
+        track[0] = pos;
+        for (int turn = 1; turn <= PlanCollisionTurn; turn++) {
+            moveChara(pos, vel);
+            track[turn] = pos;
+        }
+    }
+
+    /// ステージ開始時の CPU の状態を記録します。
+    void Solver::resetCpus(const StageAccessor& aStageAccessor) {
+        const EnemyAccessor& enemies = aStageAccessor.enemies();
+        for (int i = 0; i < enemies.count(); i++) {
+            cpuAccelCount[i] = enemies[i].accelCount();
+            cpuAccelWaitTurn[i] = enemies[i].accelWaitTurn();
+            cpuAccelWaitTurnMax[i] = Parameter::CharaAddAccelWaitTurn;
+            cpuSaveAccelTurn[i] = 0;
+        }
+    }
+
+    /// 前のターンからの CPU の状態の変化から、前のターンに加速したかと
+    /// 加速回数が増えるまでのターン数を求めます。毎ターン呼び出す必要があります。
+    void Solver::observeCpus(const StageAccessor& aStageAccessor) {
+        const EnemyAccessor& enemies = aStageAccessor.enemies();
+        for (int i = 0; i < enemies.count(); i++) {
+            const Chara& enemy = enemies[i];
+            if (enemy.isGoal()) {
+                continue;
+            }
+            // 加速回数が増えると、残りターン数が設定値に戻る
+            const bool isRecovered = cpuAccelWaitTurn[i] < enemy.accelWaitTurn();
+            if (isRecovered) {
+                cpuAccelWaitTurnMax[i] = enemy.accelWaitTurn();
+            }
+            if (0 < cpuAccelCount[i]) {
+                const int waitedCount = Math::Min(cpuAccelCount[i] + (isRecovered ? 1 : 0), Parameter::CharaAccelCountMax);
+                bool isAccel = enemy.accelCount() < waitedCount;
+                if (cpuAccelCount[i] == Parameter::CharaAccelCountMax && isRecovered) {
+                    // 回数が最大のまま増えたターンは回数では区別できないので、加速直後の速さかで判定する
+                    const float accelSpeed = Parameter::CharaAccelSpeed() - Parameter::CharaDecelSpeed();
+                    isAccel = Math::Abs(enemy.vel().length() - accelSpeed) < 0.0001f;
+                }
+                cpuSaveAccelTurn[i] = isAccel ? 0 : Math::Min(cpuSaveAccelTurn[i] + 1, CpuSaveAccelTurnMax);
+            }
+            cpuAccelCount[i] = enemy.accelCount();
+            cpuAccelWaitTurn[i] = enemy.accelWaitTurn();
+        }
+    }
+
+    /// 目指す蓮へ加速する CPU の軌跡の期待値を予測して追加します。
+    /// 速度は加速した場合としなかった場合を加速する確率で混ぜた期待値とし、
+    /// 節約して待ったターン数は取りうる値ごとの確率で持ちます。
+    /// 加速できる回数も期待値で持ち、 1 未満の場合はその値を加速できる確率とします。
+    void Solver::addCpuTrack(const Chara& enemy, int enemyNo) {
+        // 節約して待ったターン数ごとの、加速できる場合に加速する確率
+        float accelRates[CpuSaveStateCount];
+        for (int saveTurn = 0; saveTurn < CpuSaveStateCount; saveTurn++) {
+            accelRates[saveTurn] = saveTurn < CpuSaveAccelTurnMax ? (100 - CpuSaveAccelRate) / 100.0f : 1.0f;
+        }
+
+        Vec2* track = enemyTrackPos[enemyTrackCount++];
+        Vec2 pos = enemy.pos();
+        Vec2 vel = enemy.vel();
+        float accelCount = static_cast<float>(enemy.accelCount());
+        int accelWaitTurn = enemy.accelWaitTurn();
+        int targetLotusNo = enemy.targetLotusNo();
+        float saveRates[CpuSaveStateCount] = {};
+        saveRates[cpuSaveAccelTurn[enemyNo]] = 1.0f;
+        track[0] = pos;
+        for (int turn = 1; turn <= PlanCollisionTurn; turn++) {
+            // 加速できる回数が残っていない場合は、節約したターン数は変わらない
+            const float hasAccelRate = Math::Min(accelCount, 1.0f);
+            float accelRate = 0.0f;
+            float nextSaveRates[CpuSaveStateCount] = {};
+            for (int saveTurn = 0; saveTurn < CpuSaveStateCount; saveTurn++) {
+                const float rate = saveRates[saveTurn];
+                const float accelPart = hasAccelRate * rate * accelRates[saveTurn];
+                accelRate += accelPart;
+                nextSaveRates[0] += accelPart;
+                nextSaveRates[saveTurn] += (1.0f - hasAccelRate) * rate;
+                if (saveTurn + 1 < CpuSaveStateCount) {
+                    nextSaveRates[saveTurn + 1] += hasAccelRate * rate * (1.0f - accelRates[saveTurn]);
+                }
+            }
+            for (int saveTurn = 0; saveTurn < CpuSaveStateCount; saveTurn++) {
+                saveRates[saveTurn] = nextSaveRates[saveTurn];
+            }
+
+            const Vec2 toTarget = lotusPos[targetLotusNo] - pos;
+            if (0.0f < accelRate && !toTarget.isZero()) {
+                accelCount -= accelRate;
+                vel = vel * (1.0f - accelRate) + toTarget.getNormalized(Parameter::CharaAccelSpeed()) * accelRate;
+            }
+            const Circle prevRegion(pos, Parameter::CharaRadius());
+            moveChara(pos, vel);
+            track[turn] = pos;
+
+            if (--accelWaitTurn <= 0) {
+                accelCount = Math::Min(accelCount + 1.0f, static_cast<float>(Parameter::CharaAccelCountMax));
+                accelWaitTurn = cpuAccelWaitTurnMax[enemyNo];
+            }
+            for (int count = 0; count < lotusLen; count++) {
+                if (!Collision::IsHit(lotusRegion(targetLotusNo), prevRegion, pos)) {
+                    break;
+                }
+                targetLotusNo = (targetLotusNo + 1) % lotusLen;
+            }
+        }
+    }
+
+    /// 現在のステージの状態から、敵キャラの軌跡を予測します。
+    /// ゴールした敵キャラは衝突しないので予測しません。
+    void Solver::predictEnemies(const StageAccessor& aStageAccessor) {
+        const EnemyAccessor& enemies = aStageAccessor.enemies();
+        resetCpus(aStageAccessor);
+        enemyTrackCount = 0;
+        for (int i = 0; i < enemies.count(); i++) {
+            const Chara& enemy = enemies[i];
+            if (enemy.isGoal()) {
+                continue;
+            }
+            addEnemyTrack(enemy.pos(), enemy.vel());
+            addCpuTrack(enemy, i);
+        }
+    }
+
+    /// 計画を立てたターンから turn ターン後の位置 pos が、敵キャラとぶつかるかを返します。
+    bool Solver::isEnemyHit(Vec2 pos, int turn) {
+        const Circle region(pos, Parameter::CharaRadius());
+        for (int i = 0; i < enemyTrackCount; i++) {
+            if (Collision::IsHit(region, Circle(enemyTrackPos[i][turn], Parameter::CharaRadius()))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// 予想どおりに進んでいれば、計画されたこのターンの動作を返します。
+    bool Solver::followPlan(const Chara& player, Action* action) {
+        const int index = player.passedTurn() - planStartTurn;
+        if (index < 0 || planLength <= index || 0.0001f < player.pos().squareDist(planPath[index])) {
+            return false;
+        }
+        *action = planUseAccel[index] ? Action::Accel(planAimPos[index]) : Action::Wait();
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////
+
+    /// 各ステージ開始時の処理を行います。
+    void Solver::init(const StageAccessor& aStageAccessor) {
         prevLotus = aStageAccessor.player().targetLotusNo();
         lotusLen = aStageAccessor.lotuses().count();
         flow = aStageAccessor.field().flowVel();
         
-        baseAccelTiming = Parameter::CharaAccelSpeed();
-        for (int i=0; i < Parameter::CharaAddAccelWaitTurn; i++) { baseAccelTiming -=  Parameter::CharaDecelSpeed();}
+        setCoastTable();
+        baseAccelTiming = coastSpeed[Math::Min(Parameter::CharaAddAccelWaitTurn, coastTableLen - 1)];
         setAccelTTL();
         
         setLotusTargetPos(aStageAccessor);
-        
-        
-    
-        
+
+        fieldRect = aStageAccessor.field().rect();
+        for (int i = 0; i < lotusLen; i++) {
+            lotusPos[i] = aStageAccessor.lotuses()[i].pos();
+            lotusRadius[i] = aStageAccessor.lotuses()[i].radius();
+        }
+        enemyTrackCount = 0;
+        planLength = 0;
+        planLevel = 0;
+        planSearching = false;
+        planWork = 0;
     }
 
     /// 各ターンでの動作を返します。
-    /// @param[in] aStageAccessor 現在ステージの情報。
-    /// @return これから行う動作を表す Action クラス。
-    Action Answer::GetNextAction(const StageAccessor& aStageAccessor) {
-        const LotusCollection& lotuses = aStageAccessor.lotuses();
+    Action Solver::getNextAction(const StageAccessor& aStageAccessor) {
         const Chara& player = aStageAccessor.player();
-        
-        Lotus targetLotus = lotuses[player.targetLotusNo()];
-        
-        
-        bool isAccel = false;
-        if (Collision::IsHit(lotuses[prevLotus].region(), player.region())){
-            isAccel = !gettingCloser(player, targetLotus.region());
+        const TimeBudget& budget = aStageAccessor.timeBudget();
+        planWork = PlanWorkPerTurn;
+        observeCpus(aStageAccessor);
+
+        Action action;
+        if (followPlan(player, &action)) {
+            // 予想どおりに進んでいるので、このターンの候補の数だけ計画を深める
+            if (deepenPlan(player, budget)) {
+                followPlan(player, &action);
+            }
         } else {
-            isAccel = !Collision::IsHit(targetLotus.region(), player.region(), lastPos(player.pos(), player.vel()))
-            and player.vel().length() < baseAccelTiming;
-            if (isAccel) {
-                if (player.accelCount() <= 1) {
-                    isAccel = false;
-                }
+            if (!budget.isInReserve()) {
+                makePlan(aStageAccessor, budget);
+                followPlan(player, &action);
+            } else {
+                // 制限時間の予備に入っている場合は、1 手先の判定で決める
+                Vec2 targetPos;
+                const bool isAccel = decideAccel(player.pos(), player.vel(), player.accelCount()
+                                                 , player.targetLotusNo(), prevLotus, &targetPos);
+                action = isAccel ? Action::Accel(targetPos) : Action::Wait();
             }
         }
 
-        Vec2 targetPos = getTargetPos(player, targetLotus.region(), player.targetLotusNo());
-        
         prevLotus = player.targetLotusNo();
-        if (player.accelCount() > 0 && isAccel) {
-            return Action::Accel(targetPos);
-        }
-        return Action::Wait();
+        return action;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////
+
+    // Solver が StageAccessor::answerState() の領域に収まることを確かめる
+    typedef char SolverSizeCheck[sizeof(Solver) <= StageAccessor::AnswerStateSize ? 1 : -1];
+
+    /// このゲームで使う状態を返します。
+    Solver& solver(const StageAccessor& aStageAccessor) {
+        return *static_cast<Solver*>(aStageAccessor.answerState());
+    }
+
+    /// 各ステージ開始時に呼び出されます。
+    /// この関数を実装することで、各ステージに対して初期処理を行うことができます。
+    /// @param[in] aStageAccessor 現在のステージ。
+    void Answer::Init(const StageAccessor& aStageAccessor) {
+        solver(aStageAccessor).init(aStageAccessor);
+    }
+
+    /// 各ターンでの動作を返します。
+    /// @param[in] aStageAccessor 現在ステージの情報。
+    /// @return これから行う動作を表す Action クラス。
+    Action Answer::GetNextAction(const StageAccessor& aStageAccessor) {
+        return solver(aStageAccessor).getNextAction(aStageAccessor);
     }
-    
-    
 }
 
 
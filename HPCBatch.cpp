@@ -0,0 +1,433 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCBatch.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCBatch.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include "HPCCommon.hpp"
+#include "HPCMath.hpp"
+#include "HPCRandomSeed.hpp"
+#include "HPCRecordSink.hpp"
+#include "HPCScoreCompare.hpp"
+#include "HPCSimulation.hpp"
+#include "HPCStrategy.hpp"
+#include "HPCWorkerPool.hpp"
+
+namespace {
+    using namespace hpc;
+
+    /// 集計するステージ区分の最初のステージ番号。 GetStageGridSize の区分に合わせています。
+    const int BracketFirsts[Batch::BracketCount] = { 0, 10, 20, 30 };
+    /// 集計するステージ区分の最後のステージ番号。
+    const int BracketLasts[Batch::BracketCount] = { 9, 19, 29, Parameter::GameStageCount - 1 };
+
+    /// 1 つのシードの実行結果。ワーカーと共有メモリで受け渡します。
+    struct SeedResult
+    {
+        double stageScores[Parameter::GameStageCount];  ///< 各ステージの得点
+        double pastSec;                                 ///< 実行に掛かった時間
+        int isDone;                                     ///< 記録が書き込まれたか
+    };
+
+    /// Batch::RunWorker に渡すデータ
+    struct WorkerArg
+    {
+        const Batch* batch;
+        Simulation* sim;
+        SeedResult* results;
+    };
+
+    //------------------------------------------------------------------------------
+    /// 文字列の先頭から 0 以上の整数を読みます。
+    ///
+    /// @param[in,out] aStr    読み始める位置。読み終わった位置に更新されます。
+    /// @param[out]    aResult 読んだ値。
+    ///
+    /// @return 整数を読めた場合は @c true を返します。
+    bool ReadNumber(const char*& aStr, int& aResult)
+    {
+        if (*aStr < '0' || '9' < *aStr) {
+            return false;
+        }
+        char* end = 0;
+        const long value = std::strtol(aStr, &end, 10);
+        if (value < 0 || Batch::SeedCountMax < value) {
+            return false;
+        }
+        aStr = end;
+        aResult = static_cast<int>(value);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各シードの得点を、 ScoreCompare で読み込める形式で書き出します。
+    ///
+    /// @param[in] aPath       出力先のファイル名。
+    /// @param[in] aBatch      シード番号を求める Batch 。
+    /// @param[in] aResults    各シードの実行結果。
+    /// @param[in] aStageBegin 実行した最初のステージ番号。
+    /// @param[in] aStageEnd   実行した最後のステージ番号 + 1 。
+    ///
+    /// @return 出力に成功した場合は @c true を返します。
+    bool WriteScores(
+        const char* aPath
+        , const Batch& aBatch
+        , const SeedResult* aResults
+        , int aStageBegin
+        , int aStageEnd
+        )
+    {
+        std::FILE* file = std::fopen(aPath, "w");
+        if (!file) {
+            return false;
+        }
+        std::fprintf(file, "%s %d\n", ScoreCompare::FileHeader, ScoreCompare::FileVersion);
+        std::fprintf(file, "stages %d %d\n", aStageBegin, aStageEnd);
+        for (int seed = 0; seed < aBatch.seedCount(); ++seed) {
+            const SeedResult& result = aResults[seed];
+            if (!result.isDone) {
+                continue;
+            }
+            std::fprintf(file, "seed %d", aBatch.seedNumber(seed));
+            for (int stage = aStageBegin; stage < aStageEnd; ++stage) {
+                std::fprintf(file, " %.6f", result.stageScores[stage]);
+            }
+            std::fprintf(file, "\n");
+        }
+        const bool isSucceeded = !std::ferror(file);
+        return std::fclose(file) == 0 && isSucceeded;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 統計を 1 行表示します。
+    void PrintStatistics(const char* aLabel, const Statistics& aStats)
+    {
+        HPC_PRINT("%8s %12.3f %12.3f %12.3f %12.3f\n"
+            , aLabel
+            , aStats.mean()
+            , aStats.stddev()
+            , aStats.min()
+            , aStats.max()
+            );
+    }
+
+    //------------------------------------------------------------------------------
+    /// ワーカーに割り当てられたシードのゲームを aSim で実行し、結果を書き込みます。
+    ///
+    /// シードは番号順に各ワーカーへ交互に割り当てます。
+    void RunSeeds(const WorkerArg& aArg, Simulation& aSim, int aWorkerIndex, int aWorkerCount)
+    {
+        for (int seed = aWorkerIndex; seed < aArg.batch->seedCount(); seed += aWorkerCount) {
+            aSim.reset(RandomSeed().derive(aArg.batch->seedNumber(seed)));
+            aSim.run(1);
+
+            SeedResult& result = aArg.results[seed];
+            for (int stage = 0; stage < Parameter::GameStageCount; ++stage) {
+                result.stageScores[stage] = aSim.record().stage(stage).score();
+            }
+            result.pastSec = aSim.pastSec();
+            result.isDone = 1;
+        }
+    }
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// シードが指定されていない状態でインスタンスを生成します。
+    Batch::Batch()
+        : mSeedFirsts()
+        , mSeedLasts()
+        , mSeedRangeCount(0)
+        , mSeedCount(0)
+        , mScorePath(0)
+        , mIsThreaded(false)
+        , mStageBegin(0)
+        , mStageEnd(0)
+        , mWorkerCount(0)
+        , mDoneCount(0)
+        , mPastSec(0)
+        , mStageStats()
+        , mBracketStats()
+        , mTotalStats()
+        , mTimeStats()
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 実行するシード番号の一覧を文字列から設定します。
+    ///
+    /// 文字列は "A" または "A-B" の形式の範囲をカンマで区切って並べたものです。
+    /// 例えば "0-999" や "3,10-19,42" のように指定します。
+    ///
+    /// @param[in] aSeedsStr シード番号の一覧を表す文字列。
+    ///
+    /// @return 正しく解釈できた場合は @c true を返します。
+    bool Batch::setupSeeds(const char* aSeedsStr)
+    {
+        mSeedRangeCount = 0;
+        mSeedCount = 0;
+
+        const char* str = aSeedsStr;
+        while (true) {
+            int first = 0;
+            if (!ReadNumber(str, first)) {
+                return false;
+            }
+            int last = first;
+            if (*str == '-') {
+                ++str;
+                if (!ReadNumber(str, last) || last < first) {
+                    return false;
+                }
+            }
+            if (mSeedRangeCount == SeedRangeCountMax || SeedCountMax - mSeedCount < last - first + 1) {
+                return false;
+            }
+            mSeedFirsts[mSeedRangeCount] = first;
+            mSeedLasts[mSeedRangeCount] = last;
+            ++mSeedRangeCount;
+            mSeedCount += last - first + 1;
+
+            if (*str == '\0') {
+                return true;
+            }
+            if (*str != ',') {
+                return false;
+            }
+            ++str;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// run の後に、記録が得られた各シードのステージごとの得点をファイルに書き出します。
+    /// 書き出したファイルは ScoreCompare で比較できます。
+    ///
+    /// @param[in] aPath 出力先のファイル名。 0 を指定すると書き出しません。
+    ///                  文字列は run が終わるまで保持しておく必要があります。
+    void Batch::setScorePath(const char* aPath)
+    {
+        mScorePath = aPath;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ワーカーを子プロセスの代わりにスレッドとして実行するかを設定します。
+    ///
+    /// スレッドで実行する場合、各スレッドは run に渡された Simulation と同じ設定の
+    /// Simulation をそれぞれ用意するので、ゲームの状態はスレッド間で共有されません。
+    /// 処理時間は Profiler に集計されません。
+    ///
+    /// @param[in] aIsThreaded スレッドで実行する場合は @c true 。既定値は @c false です。
+    void Batch::setThreaded(bool aIsThreaded)
+    {
+        mIsThreaded = aIsThreaded;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return setupSeeds で設定したシードの総数。
+    int Batch::seedCount()const
+    {
+        return mSeedCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex シードの番号。 [0, seedCount()) の範囲で指定します。
+    ///
+    /// @return aIndex 番目に実行するシード番号。
+    int Batch::seedNumber(int aIndex)const
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, mSeedCount);
+        int index = aIndex;
+        for (int range = 0; range < mSeedRangeCount; ++range) {
+            const int count = mSeedLasts[range] - mSeedFirsts[range] + 1;
+            if (index < count) {
+                return mSeedFirsts[range] + index;
+            }
+            index -= count;
+        }
+        HPC_SHOULD_NOT_REACH_HERE();
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// すべてのシードでゲームを実行し、得点を集計します。
+    ///
+    /// 各ゲームは aSim の状態を設定し直して実行するため、 aSim の記録は
+    /// 最後に実行したシードのものになります。
+    /// 実行するステージの範囲は aSim に設定されたものに従います。
+    ///
+    /// @param[in,out] aSim         ゲームの実行に使う Simulation 。
+    /// @param[in]     aWorkerCount ワーカー数。0 を指定した場合は利用可能なコア数になります。
+    ///
+    /// @return すべてのシードを実行し、得点ファイルも書き出せた場合は @c true を返します。
+    bool Batch::run(Simulation& aSim, int aWorkerCount)
+    {
+        HPC_LB_ASSERT_I(mSeedCount, 0);
+
+        mStageBegin = aSim.stageBegin();
+        mStageEnd = aSim.stageEnd();
+        mWorkerCount = Math::Min(WorkerPool::ValidWorkerCount(aWorkerCount), mSeedCount);
+        mDoneCount = 0;
+        mPastSec = 0;
+        for (int index = 0; index < Parameter::GameStageCount; ++index) {
+            mStageStats[index].reset();
+        }
+        for (int index = 0; index < BracketCount; ++index) {
+            mBracketStats[index].reset();
+        }
+        mTotalStats.reset();
+        mTimeStats.reset();
+
+        const int sharedSize = static_cast<int>(sizeof(SeedResult)) * mSeedCount;
+        SeedResult* results = static_cast<SeedResult*>(WorkerPool::AllocShared(sharedSize));
+        if (!results) {
+            HPC_PRINT("Failed to allocate shared memory.\n");
+            return false;
+        }
+
+        // 得点の集計には各ターンの内容は不要なので、記録しない
+        RecordSink nullSink;
+        aSim.setRecordSink(&nullSink);
+
+        WorkerArg arg;
+        arg.batch = this;
+        arg.sim = &aSim;
+        arg.results = results;
+        const bool isSucceeded = mIsThreaded
+            ? WorkerPool::RunThreads(mWorkerCount, &Batch::RunThread, &arg)
+            : WorkerPool::Run(mWorkerCount, &Batch::RunWorker, &arg);
+        if (!isSucceeded) {
+            HPC_PRINT("Some seeds may not have been recorded.\n");
+        }
+        aSim.setRecordSink(0);
+
+        // 結果を集める
+        for (int seed = 0; seed < mSeedCount; ++seed) {
+            const SeedResult& result = results[seed];
+            if (!result.isDone) {
+                continue;
+            }
+            ++mDoneCount;
+            mPastSec += result.pastSec;
+            mTimeStats.add(result.pastSec);
+
+            for (int stage = mStageBegin; stage < mStageEnd; ++stage) {
+                mStageStats[stage].add(result.stageScores[stage]);
+            }
+            for (int bracket = 0; bracket < BracketCount; ++bracket) {
+                const int first = Math::Max(BracketFirsts[bracket], mStageBegin);
+                const int last = Math::Min(BracketLasts[bracket], mStageEnd - 1);
+                if (last < first) {
+                    continue;
+                }
+                double bracketScore = 0;
+                for (int stage = first; stage <= last; ++stage) {
+                    bracketScore += result.stageScores[stage];
+                }
+                mBracketStats[bracket].add(bracketScore);
+            }
+
+            // Record::score と同じく、合計してから整数に丸める
+            double total = 0;
+            for (int stage = 0; stage < Parameter::GameStageCount; ++stage) {
+                total += result.stageScores[stage];
+            }
+            mTotalStats.add(static_cast<int>(total));
+        }
+
+        bool isWritten = true;
+        if (mScorePath && !WriteScores(mScorePath, *this, results, mStageBegin, mStageEnd)) {
+            HPC_PRINT("Failed to write %s.\n", mScorePath);
+            isWritten = false;
+        }
+
+        WorkerPool::FreeShared(results, sharedSize);
+        return isWritten && mDoneCount == mSeedCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 集計結果を表示します。
+    ///
+    /// ステージごと、ステージ区分ごと、合計の得点について、
+    /// シード間の平均・標準偏差・最小値・最大値を表示します。
+    void Batch::outputResult()const
+    {
+        HPC_PRINT("Done.\n");
+        HPC_PRINT("%8s:%8d / %d\n", "Seeds", mDoneCount, mSeedCount);
+        HPC_PRINT("%8s:%8d\n", "Workers", mWorkerCount);
+        HPC_PRINT("%8s:%8d - %d\n", "Stages", mStageBegin, mStageEnd - 1);
+        if (mDoneCount == 0) {
+            return;
+        }
+
+        HPC_PRINT("\n%8s %12s %12s %12s %12s\n", "Stage", "Mean", "StdDev", "Min", "Max");
+        char label[16];
+        for (int stage = mStageBegin; stage < mStageEnd; ++stage) {
+            std::sprintf(label, "%d", stage);
+            PrintStatistics(label, mStageStats[stage]);
+        }
+
+        HPC_PRINT("\n%8s %12s %12s %12s %12s\n", "Bracket", "Mean", "StdDev", "Min", "Max");
+        for (int bracket = 0; bracket < BracketCount; ++bracket) {
+            if (mBracketStats[bracket].count() == 0) {
+                continue;
+            }
+            // 実行範囲で切り詰めた区分を表示する
+            std::sprintf(label, "%d-%d"
+                , Math::Max(BracketFirsts[bracket], mStageBegin)
+                , Math::Min(BracketLasts[bracket], mStageEnd - 1)
+                );
+            PrintStatistics(label, mBracketStats[bracket]);
+        }
+
+        HPC_PRINT("\n");
+        PrintStatistics("Score", mTotalStats);
+        PrintStatistics("Time", mTimeStats);
+        HPC_PRINT("%8s:%8.4f\n", "TimeSum", mPastSec);
+    }
+
+    //------------------------------------------------------------------------------
+    /// WorkerPool::Run から子プロセスで呼ばれ、割り当てられたシードのゲームを実行します。
+    ///
+    /// 子プロセスは呼び出し元の Simulation の複製を持つので、それをそのまま使います。
+    void Batch::RunWorker(int aWorkerIndex, int aWorkerCount, void* aUserData)
+    {
+        WorkerArg* arg = static_cast<WorkerArg*>(aUserData);
+        RunSeeds(*arg, *arg->sim, aWorkerIndex, aWorkerCount);
+    }
+
+    //------------------------------------------------------------------------------
+    /// WorkerPool::RunThreads からスレッドで呼ばれ、割り当てられたシードのゲームを実行します。
+    ///
+    /// スレッドはメモリを共有するので、ゲームの状態をすべて持つ Simulation を
+    /// スレッドごとに用意し、呼び出し元の Simulation から設定を写して使います。
+    void Batch::RunThread(int aWorkerIndex, int aWorkerCount, void* aUserData)
+    {
+        WorkerArg* arg = static_cast<WorkerArg*>(aUserData);
+        const Simulation& base = *arg->sim;
+
+        RecordSink nullSink;
+        Simulation sim;
+        sim.setStageRange(base.stageBegin(), base.stageEnd());
+        sim.setRecordSink(&nullSink);
+        sim.setProfiled(false);
+        sim.setDeadlineEnabled(base.isDeadlineEnabled());
+        if (!sim.setPlayerStrategy(base.playerStrategy())) {
+            HPC_PRINT("Failed to set up %s.\n", base.playerStrategy().name);
+            return;
+        }
+        RunSeeds(*arg, sim, aWorkerIndex, aWorkerCount);
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Batch クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCParameter.hpp"
+#include "HPCStatistics.hpp"
+
+namespace hpc {
+
+    class Simulation;
+
+    //------------------------------------------------------------------------------
+    /// 複数のシードでゲームを実行し、得点の統計を集計します。
+    ///
+    /// シード番号 n のゲームは RandomSeed().derive(n) をシードとして実行されます。
+    /// 各シードのゲームはワーカーに分担され、それぞれ 1 回分のゲームとして
+    /// 制限時間を計測します。ワーカーは子プロセスか、同じプロセスのスレッドです。
+    class Batch
+    {
+    public:
+        static const int SeedRangeCountMax = 64;        ///< 指定できるシード範囲の数の上限
+        static const int SeedCountMax = 1000000;        ///< 指定できるシードの数の上限
+        static const int BracketCount = 4;              ///< 集計するステージ区分の数
+
+        Batch();
+
+        bool setupSeeds(const char* aSeedsStr);         ///< 実行するシード番号の一覧を設定します。
+        void setScorePath(const char* aPath);           ///< 各シードの得点を書き出すファイルを設定します。
+        void setThreaded(bool aIsThreaded);             ///< ワーカーをスレッドで実行するかを設定します。
+        int seedCount()const;                           ///< 実行するシードの数を返します。
+        int seedNumber(int aIndex)const;                ///< aIndex 番目のシード番号を返します。
+
+        bool run(Simulation& aSim, int aWorkerCount);   ///< すべてのシードでゲームを実行します。
+        void outputResult()const;                       ///< 集計結果を表示します。
+
+    private:
+        int mSeedFirsts[SeedRangeCountMax];             ///< 各シード範囲の最初のシード番号
+        int mSeedLasts[SeedRangeCountMax];              ///< 各シード範囲の最後のシード番号
+        int mSeedRangeCount;                            ///< シード範囲の数
+        int mSeedCount;                                 ///< シードの総数
+        const char* mScorePath;                         ///< 各シードの得点を書き出すファイル
+        bool mIsThreaded;                               ///< ワーカーをスレッドで実行するか
+        int mStageBegin;                                ///< 集計した最初のステージ番号
+        int mStageEnd;                                  ///< 集計した最後のステージ番号 + 1
+        int mWorkerCount;                               ///< 実行したワーカー数
+        int mDoneCount;                                 ///< 記録が得られたシードの数
+        double mPastSec;                                ///< 全ゲームの実行時間の合計
+        Statistics mStageStats[Parameter::GameStageCount]; ///< ステージごとの得点の統計
+        Statistics mBracketStats[BracketCount];         ///< ステージ区分ごとの合計得点の統計
+        Statistics mTotalStats;                         ///< 合計得点の統計
+        Statistics mTimeStats;                          ///< 1 ゲームの実行時間の統計
+
+        static void RunWorker(int aWorkerIndex, int aWorkerCount, void* aUserData);
+        static void RunThread(int aWorkerIndex, int aWorkerCount, void* aUserData);
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
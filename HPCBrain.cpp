@@ -16,14 +16,10 @@
 #include "HPCCommon.hpp"
 #include "HPCMath.hpp"
 #include "HPCParameter.hpp"
+#include "HPCProfileProbe.hpp"
 #include "HPCRandom.hpp"
 #include "HPCStageAccessor.hpp"
-
-namespace {
-    using namespace hpc;
-    
-    const int CpuSaveAccelTurnMax = 2;
-}
+#include "HPCStrategyInstance.hpp"
 
 namespace hpc {
 
@@ -32,6 +28,8 @@ namespace hpc {
     Brain::Brain()
         : mCharaParam()
         , mCpuSaveAccelTurn(0)
+        , mStrategy(0)
+        , mProfiler(0)
     {
         reset();
     }
@@ -51,6 +49,47 @@ namespace hpc {
     {
         mCharaParam = aCharaParam;
     }
+
+    //------------------------------------------------------------------------------
+    /// 人間キャラの動作を、 Answer の代わりに指定した戦略で決めるようにします。
+    ///
+    /// @param[in] aStrategy 戦略。 0 を指定すると Answer を直接呼び出します。
+    void Brain::setStrategy(StrategyInstance* aStrategy)
+    {
+        mStrategy = aStrategy;
+    }
+
+    //------------------------------------------------------------------------------
+    /// Answer と CPU の思考時間を集計するようにします。
+    ///
+    /// @param[in] aProfiler 集計先。 0 を指定すると集計しません。
+    void Brain::setProfiler(Profiler* aProfiler)
+    {
+        mProfiler = aProfiler;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 戦略と集計先はゲームが所有するので保存しません。
+    /// 保存先の戦略と集計先は設定されていない状態になります。
+    ///
+    /// @param[out] aState 保存先。
+    void Brain::save(Brain& aState)const
+    {
+        aState.mCharaParam = mCharaParam;
+        aState.mCpuSaveAccelTurn = mCpuSaveAccelTurn;
+        aState.mStrategy = 0;
+        aState.mProfiler = 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 設定されている戦略と集計先は変更しません。
+    ///
+    /// @param[in] aState save で保存した状態。
+    void Brain::restore(const Brain& aState)
+    {
+        mCharaParam = aState.mCharaParam;
+        mCpuSaveAccelTurn = aState.mCpuSaveAccelTurn;
+    }
     
     //------------------------------------------------------------------------------
     /// ステージ開始前の準備処理を行います。
@@ -61,9 +100,16 @@ namespace hpc {
     {
         switch (mCharaParam.type()) {
         case CharaType_Human:
-            // Answer::Init でプレイヤーの初期状態を参照できるようにします。
-            // 但し、Init でステージの状態を書き換えることはできません。
-            Answer::Init(aStageAccessor);
+            {
+                // Answer::Init でプレイヤーの初期状態を参照できるようにします。
+                // 但し、Init でステージの状態を書き換えることはできません。
+                ProfileProbe probe(mProfiler, ProfilePhase_AnswerInit);
+                if (mStrategy) {
+                    mStrategy->init(aStageAccessor);
+                } else {
+                    Answer::Init(aStageAccessor);
+                }
+            }
             break;
 
         case CharaType_Cpu:
@@ -90,10 +136,19 @@ namespace hpc {
     {
         switch (mCharaParam.type()) {
         case CharaType_Human:
-            return Answer::GetNextAction(aStageAccessor);
+            {
+                ProfileProbe probe(mProfiler, ProfilePhase_AnswerGetNextAction);
+                if (mStrategy) {
+                    return mStrategy->getNextAction(aStageAccessor);
+                }
+                return Answer::GetNextAction(aStageAccessor);
+            }
 
         case CharaType_Cpu:
-            return getCpuNextAction(aStageAccessor, aRandom);
+            {
+                ProfileProbe probe(mProfiler, ProfilePhase_CpuBrain);
+                return getCpuNextAction(aStageAccessor, aRandom);
+            }
 
         default:
             HPC_SHOULD_NOT_REACH_HERE();
@@ -126,32 +181,56 @@ namespace hpc {
         )
     {
         const Chara& player = aStageAccessor.player();
-        
+        return CpuNextAction(
+            player.pos()
+            , player.accelCount()
+            , aStageAccessor.lotuses()[player.targetLotusNo()].pos()
+            , mCpuSaveAccelTurn
+            , aRandom
+            );
+    }
+
+    //------------------------------------------------------------------------------
+    /// CPUの動作を決定します。
+    /// Brain のインスタンスを持たなくても CPU と同じ動作を再現できます。
+    ///
+    /// @param[in]     aPos             キャラの現在位置。
+    /// @param[in]     aAccelCount      キャラの加速できる回数。
+    /// @param[in]     aTargetLotusPos  キャラが目指す蓮の位置。
+    /// @param[in,out] aSaveAccelTurn   加速を節約して待機したターン数。
+    /// @param[in]     aRandom          乱数クラス。
+    ///
+    /// @return 次の動作
+    Action Brain::CpuNextAction(
+        const Vec2& aPos
+        , int aAccelCount
+        , const Vec2& aTargetLotusPos
+        , int& aSaveAccelTurn
+        , Random& aRandom
+        )
+    {
         // 乱数を使うものは最初に計算
         const float slurDeg = static_cast<float>(
-            aRandom.randMinMax(17, 20) * (aRandom.randTerm(2) == 0 ? -1 : 1)
+            aRandom.randMinMax(CpuSlurDegMin, CpuSlurDegMax) * (aRandom.randTerm(2) == 0 ? -1 : 1)
             );
-        const bool isSaveAccel = aRandom.randTerm(100) < 40;
+        const bool isSaveAccel = aRandom.randTerm(100) < CpuSaveAccelRate;
         
         // 加速回数が0なら何もしない
-        if (player.accelCount() == 0) {
+        if (aAccelCount == 0) {
             return Action::Wait();
         }
         
         // 加速節約フラグが立っていたら何もしない
         // ただし、一定ターン節約し続けていた場合は除く
         if (isSaveAccel) {
-            if (mCpuSaveAccelTurn < CpuSaveAccelTurnMax) {
-                ++mCpuSaveAccelTurn;
+            if (aSaveAccelTurn < CpuSaveAccelTurnMax) {
+                ++aSaveAccelTurn;
                 return Action::Wait();
             }
         }
-        mCpuSaveAccelTurn = 0;
+        aSaveAccelTurn = 0;
 
-        const int targetLotusNo = player.targetLotusNo();
-        const Lotus& targetLotus = aStageAccessor.lotuses()[targetLotusNo];
-        const Vec2 targetLotusPos = targetLotus.pos();
-        Vec2 toTargetVec = targetLotusPos - player.pos();
+        Vec2 toTargetVec = aTargetLotusPos - aPos;
         
 //        if (true) return Action::Wait();
 
@@ -162,7 +241,7 @@ namespace hpc {
         // 目標座標をぶれさせる
         toTargetVec.rotate(Math::DegToRad(slurDeg));
         
-        return Action::Accel(player.pos() + toTargetVec);
+        return Action::Accel(aPos + toTargetVec);
     }
 }
 //------------------------------------------------------------------------------
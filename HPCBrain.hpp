@@ -15,18 +15,32 @@
 
 namespace hpc {
 
+    class Profiler;
     class Random;
     class StageAccessor;
+    class StrategyInstance;
     
     //------------------------------------------------------------------------------
     /// キャラの動作を決定します。
     class Brain
     {
     public:
+        /// @name CPU の動作の設定値
+        //@{
+        static const int CpuSaveAccelTurnMax = 2;           ///< 加速を節約して待機し続ける最大ターン数
+        static const int CpuSaveAccelRate = 40;             ///< 加速を節約する確率 (%)
+        static const int CpuSlurDegMin = 17;                ///< 目標の向きをぶらす角度の最小値 (度)
+        static const int CpuSlurDegMax = 20;                ///< 目標の向きをぶらす角度の最大値 (度)
+        //@}
+
         Brain();
 
         void reset();                                       ///< リセットします。
         void setup(const CharaParam& aCharaParam);          ///< 初期状態を設定します。
+        void setStrategy(StrategyInstance* aStrategy);      ///< プレイヤーの動作を決める戦略を設定します。
+        void setProfiler(Profiler* aProfiler);              ///< 処理時間の集計先を設定します。
+        void save(Brain& aState)const;                      ///< 戦略を除いた状態を保存します。
+        void restore(const Brain& aState);                  ///< save で保存した状態に戻します。
         
         void init(const StageAccessor& aStageAccessor);     ///< 準備処理を行います。
         /// 次の動作を返します。
@@ -34,10 +48,20 @@ namespace hpc {
             const StageAccessor& aStageAccessor
             , Random& aRandom
             );
+        /// 節約したターン数を指定して、次の動作を返します。(CPU)
+        static Action CpuNextAction(
+            const Vec2& aPos
+            , int aAccelCount
+            , const Vec2& aTargetLotusPos
+            , int& aSaveAccelTurn
+            , Random& aRandom
+            );
 
     private:
         CharaParam mCharaParam;     ///< キャラのパラメータ
         int mCpuSaveAccelTurn;      ///< 加速を節約して待機したターン数(CPU)
+        StrategyInstance* mStrategy;    ///< プレイヤーの動作を決める戦略(人間)
+        Profiler* mProfiler;        ///< 処理時間の集計先。集計しなければ 0
         
         void initCpu(const StageAccessor& aStageAccessor);  ///< 準備処理を行います。(CPU)
         /// 次の動作を返します。(CPU)
@@ -11,10 +11,11 @@
 
 #include "HPCChara.hpp"
 
+#include "HPCCharaHotBlock.hpp"
 #include "HPCCommon.hpp"
-#include "HPCMath.hpp"
 #include "HPCParameter.hpp"
 #include "HPCRandom.hpp"
+#include "HPCStage.hpp"
 
 namespace hpc {
 
@@ -23,18 +24,23 @@ namespace hpc {
     Chara::Chara()
         : mStageAccessor()
         , mBrain()
-        , mRegion(Vec2(), Parameter::CharaRadius())
-        , mPrevRegion(Vec2(), Parameter::CharaRadius())
         , mDecidedAction()
-        , mVel()
-        , mAccelCount(0)
-        , mAccelWaitTurn(0)
-        , mAccelWaitTurnMax(0)
-        , mTargetLotusNo(0)
-        , mRoundCount(0)
-        , mRank(0)
-        , mPassedTurn(0)
+        , mHotBlock(0)
+        , mIndex(0)
     {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 位置や速度など、移動計算で参照する状態の格納先を設定します。
+    /// CharaCollection が所有する CharaHotBlock を指定します。
+    ///
+    /// @param[in] aHotBlock 状態の格納先。
+    /// @param[in] aIndex    aHotBlock 内でのインデックス。
+    void Chara::setupHotBlock(CharaHotBlock& aHotBlock, int aIndex)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, Parameter::CharaCountMax);
+        mHotBlock = &aHotBlock;
+        mIndex = aIndex;
         reset();
     }
 
@@ -45,6 +51,8 @@ namespace hpc {
     void Chara::init(const Stage& aStage, int aCharaIndex)
     {
         mStageAccessor.init(aStage, aCharaIndex);
+        mBrain.setStrategy(aStage.playerStrategy());
+        mBrain.setProfiler(aStage.profiler());
         mBrain.init(mStageAccessor);
     }
 
@@ -53,11 +61,23 @@ namespace hpc {
     void Chara::decideAction(Random& aRandom)
     {
         // 衝突判定用に、前回領域を覚えておく
-        mPrevRegion = mRegion;
+        mHotBlock->prevPos[mIndex] = mHotBlock->pos[mIndex];
         
         mDecidedAction = mBrain.getNextAction(mStageAccessor, aRandom);
     }
 
+    //------------------------------------------------------------------------------
+    /// Brain に問い合わせずに、次に実行する動作を指定します。
+    ///
+    /// @param[in] aAction 実行する動作。
+    void Chara::setAction(const Action& aAction)
+    {
+        // 衝突判定用に、前回領域を覚えておく
+        mHotBlock->prevPos[mIndex] = mHotBlock->pos[mIndex];
+        
+        mDecidedAction = aAction;
+    }
+
     //------------------------------------------------------------------------------
     /// 動作を実行します。
     void Chara::execAction()
@@ -69,7 +89,7 @@ namespace hpc {
 
         case ActionType_Accel:
             // 加速できるなら加速
-            accelIfPossible(mDecidedAction.value());
+            mHotBlock->accel(mIndex, mDecidedAction.value());
             break;
 
         default:
@@ -85,42 +105,21 @@ namespace hpc {
     /// 移動処理を行います。
     void Chara::move()
     {
-        // 速度分移動 ＆ フィールドの流れる速度を反映
-        mRegion.move(mVel + mStageAccessor.field().flowVel());
-        
-        // 減速させる
-        if (!mVel.isZero()) {
-            const float len = Math::Max(
-                mVel.length() - Parameter::CharaDecelSpeed()
-                , 0.0f
-                );
-            if (0.0f < len) {
-                mVel.normalize(len);
-            } else {
-                mVel.reset();
-            }
-        }
+        mHotBlock->move(mIndex, mStageAccessor.field().flowVel());
     }
 
     //------------------------------------------------------------------------------
     /// めり込み補正を行います。
     void Chara::separation(const Vec2& aSeparateVec)
     {
-        mRegion.move(aSeparateVec);
+        mHotBlock->pos[mIndex] += aSeparateVec;
     }
 
     //------------------------------------------------------------------------------
     /// ターン経過処理を行います。
     void Chara::updateTurn()
     {
-        HPC_ASSERT(!isGoal());
-        
-        ++mPassedTurn;
-        --mAccelWaitTurn;
-        if (mAccelWaitTurn <= 0) {
-            mAccelCount = Math::Min(mAccelCount + 1, Parameter::CharaAccelCountMax);
-            mAccelWaitTurn = mAccelWaitTurnMax;
-        }
+        mHotBlock->updateTurn(mIndex);
     }
 
     //------------------------------------------------------------------------------
@@ -128,48 +127,15 @@ namespace hpc {
     /// フィールド外に出ていた場合、座標補正と同時に速度がゼロになります。
     void Chara::correctInside()
     {
-        const Rectangle fieldRect = mStageAccessor.field().rect();
-        
-        Vec2 myPos = mRegion.pos();
-        const float radius = mRegion.radius();
-        bool isCorrect = false;
-        
-        if (myPos.x - radius < fieldRect.left) {
-            myPos.x = fieldRect.left + radius;
-            isCorrect = true;
-        } else if (fieldRect.right < myPos.x + radius) {
-            myPos.x = fieldRect.right - radius;
-            isCorrect = true;
-        }
-        if (myPos.y - radius < fieldRect.bottom) {
-            myPos.y = fieldRect.bottom + radius;
-            isCorrect = true;
-        } else if (fieldRect.top < myPos.y + radius) {
-            myPos.y = fieldRect.top - radius;
-            isCorrect = true;
-        }
-        
-        if (isCorrect) {
-            mRegion.setPos(myPos);
-            mVel.reset();
-        }
+        mHotBlock->correctInside(mIndex, mStageAccessor.field().rect());
     }
 
     //------------------------------------------------------------------------------
     /// 状態をリセットします。
     void Chara::reset()
     {
-        mRegion.setPos(hpc::Vec2());
-        mPrevRegion.setPos(hpc::Vec2());
         mBrain.reset();
-        mVel.reset();
-        mAccelCount = Parameter::CharaInitAccelCount;
-        mAccelWaitTurn = Parameter::CharaAddAccelWaitTurn;
-        mAccelWaitTurnMax = Parameter::CharaAddAccelWaitTurn;
-        mTargetLotusNo = 0;
-        mRoundCount = 0;
-        mRank = 0;
-        mPassedTurn = 0;
+        mHotBlock->reset(mIndex);
     }
 
     //------------------------------------------------------------------------------
@@ -179,14 +145,14 @@ namespace hpc {
     /// @param[in] aCharaType キャラのパラメータ
     void Chara::setup(const Vec2& aPos, const CharaParam& aCharaParam)
     {
-        mRegion.setPos(aPos);
-        mPrevRegion.setPos(aPos);
+        mHotBlock->pos[mIndex] = aPos;
+        mHotBlock->prevPos[mIndex] = aPos;
         mBrain.setup(aCharaParam);
         
         // パラメータ設定
         {
             const float strRate = static_cast<float>(aCharaParam.strength()) / 100.0f;
-            mAccelWaitTurnMax = Parameter::CharaAddAccelWaitTurn - static_cast<int>(strRate * 2 + 0.5f);
+            mHotBlock->accelWaitTurnMax[mIndex] = Parameter::CharaAddAccelWaitTurn - static_cast<int>(strRate * 2 + 0.5f);
         }
     }
 
@@ -194,12 +160,7 @@ namespace hpc {
     /// 次に目指す蓮の番号を１つ進めます。
     void Chara::incTargetLotusNo()
     {
-        ++mTargetLotusNo;
-        // 一周回ったら周回数加算
-        if (mStageAccessor.lotuses().count() == mTargetLotusNo) {
-            mTargetLotusNo = 0;
-            ++mRoundCount;
-        }
+        mHotBlock->incTargetLotusNo(mIndex, mStageAccessor.lotuses().count());
     }
 
     //------------------------------------------------------------------------------
@@ -208,7 +169,7 @@ namespace hpc {
     /// @param[in] aVel       速度
     void Chara::setVel(const Vec2& aVel)
     {
-        mVel = aVel;
+        mHotBlock->vel[mIndex] = aVel;
     }
 
     //------------------------------------------------------------------------------
@@ -217,122 +178,111 @@ namespace hpc {
     /// @param[in] aRank    順位
     void Chara::setRank(const int aRank)
     {
-        mRank = aRank;
+        mHotBlock->rank[mIndex] = aRank;
     }
 
     //------------------------------------------------------------------------------
     /// キャラの領域を表す円を返します。
     ///
     /// @return キャラの領域を表す Circle
-    const Circle& Chara::region()const
+    Circle Chara::region()const
     {
-        return mRegion;
+        return Circle(mHotBlock->pos[mIndex], Parameter::CharaRadius());
     }
 
     //------------------------------------------------------------------------------
     /// @return キャラの現在位置
     Vec2 Chara::pos()const
     {
-//        Vec2 pos = mRegion.pos();
-//        HPC_PRINT("Pos: (%f, %f)\n", pos.x, pos.y);
-
-        return mRegion.pos();
+        return mHotBlock->pos[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// @return キャラの現在速度
     Vec2 Chara::vel()const
     {
-//        HPC_PRINT("Vel: (%f, %f)\n", mVel.x, mVel.y);
-        return mVel;
+        return mHotBlock->vel[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// @return ゴールしたか
     bool Chara::isGoal()const
     {
-        return mRoundCount == Parameter::StageRoundCount;
+        return mHotBlock->isGoal(mIndex);
     }
 
     //------------------------------------------------------------------------------
     /// @return 加速できる回数
     int Chara::accelCount()const
     {
-        return mAccelCount;
+        return mHotBlock->accelCount[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// @return 加速回数が増えるまでの残りターン数
     int Chara::accelWaitTurn()const
     {
-        return mAccelWaitTurn;
+        return mHotBlock->accelWaitTurn[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// @return 現在の目指す蓮番号
     int Chara::targetLotusNo()const
     {
-//        HPC_PRINT("%d",mTargetLotusNo);
-        return mTargetLotusNo;
+        return mHotBlock->targetLotusNo[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// @return 周回数
     int Chara::roundCount()const
     {
-        return mRoundCount;
+        return mHotBlock->roundCount[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// @return 順位
     int Chara::rank()const
     {
-        return mRank;
+        return mHotBlock->rank[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// @return 通過した蓮の数
     int Chara::passedLotusCount()const
     {
-        return mRoundCount * mStageAccessor.lotuses().count() + mTargetLotusNo;
+        return mHotBlock->passedLotusCount(mIndex, mStageAccessor.lotuses().count());
     }
 
     //------------------------------------------------------------------------------
     /// @return 経過ターン数
     int Chara::passedTurn()const
     {
-        return mPassedTurn;
+        return mHotBlock->passedTurn[mIndex];
     }
 
     //------------------------------------------------------------------------------
     /// キャラの前回領域を表す円を返します。
     ///
     /// @return キャラの領域を表す Circle
-    const Circle& Chara::prevRegion()const
+    Circle Chara::prevRegion()const
     {
-        return mPrevRegion;
+        return Circle(mHotBlock->prevPos[mIndex], Parameter::CharaRadius());
     }
 
     //------------------------------------------------------------------------------
-    /// 加速できるなら加速します。
-    void Chara::accelIfPossible(const Vec2& aTargetPos)
+    /// @return 動作決定モジュール
+    const Brain& Chara::brain()const
     {
-        // 加速可能回数がゼロの場合、何もしない
-        if (mAccelCount <= 0) {
-            return;
-        }
-        
-        const Vec2 toTargetVec = aTargetPos - pos();
-        
-        // 目標座標とキャラ座標が同値の場合、何もしない
-        if (toTargetVec.isZero()) {
-            return;
-        }
-        
-        --mAccelCount;
-        
-        // 目標座標方向への一定加速度を設定する（加算ではなく、上書き）
-        mVel = toTargetVec.getNormalized(Parameter::CharaAccelSpeed());
+        return mBrain;
+    }
+
+    //------------------------------------------------------------------------------
+    /// Brain::save で保存した状態に戻します。プレイヤーの戦略は変更しません。
+    ///
+    /// @param[in] aBrain 保存した動作決定モジュールの状態
+    void Chara::restoreBrain(const Brain& aBrain)
+    {
+        mBrain.restore(aBrain);
     }
 }
 //------------------------------------------------------------------------------
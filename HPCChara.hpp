@@ -19,6 +19,7 @@ namespace hpc {
     
     class CharaParam;
     class Random;
+    struct CharaHotBlock;
     
     //------------------------------------------------------------------------------
     /// キャラの情報を保持します。
@@ -27,8 +28,10 @@ namespace hpc {
     public:
         Chara();
 
+        void setupHotBlock(CharaHotBlock& aHotBlock, int aIndex); ///< 移動計算用の状態の格納先を設定します。
         void init(const Stage& aStage, int aCharaIndex);    ///< 準備処理を行います。
         void decideAction(Random& aRandom);                 ///< 動作を決定します。
+        void setAction(const Action& aAction);              ///< 動作を指定します。
         void execAction();                                  ///< 動作を実行します。
         void move();                                        ///< 移動処理を行います。
         void separation(const Vec2& aSeparateVec);          ///< めり込み補正を行います。
@@ -41,7 +44,7 @@ namespace hpc {
         void setVel(const Vec2& aVel);                      ///< 速度を設定します。
         void setRank(int aRank);                            ///< 順位を設定します。
 
-        const Circle& region()const;                        ///< 領域を表す円を返します。
+        Circle region()const;                               ///< 領域を表す円を返します。
         Vec2 pos()const;                                    ///< 現在位置を返します。
         Vec2 vel()const;                                    ///< 現在速度を返します。
         bool isGoal()const;                                 ///< ゴールしたかどうかを返します。
@@ -53,24 +56,17 @@ namespace hpc {
         int passedLotusCount()const;                        ///< 通過した蓮の数を返します。
         int passedTurn()const;                              ///< 経過ターン数を返します。
         
-        const Circle& prevRegion()const;                    ///< 前回領域を表す円を返します。
+        Circle prevRegion()const;                           ///< 前回領域を表す円を返します。
+
+        const Brain& brain()const;                          ///< 動作決定モジュールを返します。
+        void restoreBrain(const Brain& aBrain);             ///< 動作決定モジュールの状態を復元します。
 
     private:
         StageAccessor mStageAccessor;   ///< ステージ情報のアクセサ
         Brain mBrain;                   ///< 動作決定モジュール
-        Circle mRegion;                 ///< 領域
-        Circle mPrevRegion;             ///< 前回領域
         Action mDecidedAction;          ///< 決定された動作
-        Vec2 mVel;                      ///< 速度
-        int mAccelCount;                ///< 加速できる回数
-        int mAccelWaitTurn;             ///< 加速回数が増えるまでの残りターン数
-        int mAccelWaitTurnMax;          ///< 加速回数が増えるまでの残りターン数 の設定値
-        int mTargetLotusNo;             ///< 現在の目指す蓮番号
-        int mRoundCount;                ///< 周回数
-        int mRank;                      ///< 順位
-        int mPassedTurn;                ///< 経過ターン数
-        
-        void accelIfPossible(const Vec2& aTargetPos);       ///< 加速できるなら加速します。
+        CharaHotBlock* mHotBlock;       ///< 位置や速度などの格納先
+        int mIndex;                     ///< mHotBlock 内でのインデックス
     };
 }
 //------------------------------------------------------------------------------
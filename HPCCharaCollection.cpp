@@ -11,72 +11,38 @@
 
 #include "HPCCharaCollection.hpp"
 
-#include "HPCCollision.hpp"
 #include "HPCCommon.hpp"
+#include "HPCProfileProbe.hpp"
 #include "HPCStage.hpp"
 
 namespace {
     using namespace hpc;
     
     //------------------------------------------------------------------------------
-    /// 速度ベクトル計算用構造体
-    struct CalcVelSet
+    /// aIndexB のキャラより aIndexA のキャラが上位かどうかを返します。
+    bool IsHighOrder(const CharaHotBlock& aBlock, int aIndexA, int aIndexB, int aLotusCount)
     {
-        Vec2 vels[Parameter::CharaCountMax];
-        Vec2 ofsSeparateVec;
-        int count;
+        const bool isGoalA = aBlock.isGoal(aIndexA);
+        const bool isGoalB = aBlock.isGoal(aIndexB);
 
-        CalcVelSet()
-            : vels()
-            , ofsSeparateVec()
-            , count(0)
-        {
-        }
-        
-        void addVel(const Vec2& aVel, const Vec2& aOfsSeparateVec)
-        {
-            HPC_ASSERT(count < Parameter::CharaCountMax);
-            vels[count++] = aVel;
-            ofsSeparateVec += aOfsSeparateVec;
-        }
-        
-        Vec2 calculatedVel()const
-        {
-            if (count == 0) {
-                return Vec2();
-            }
-            
-            Vec2 totalVel;
-            for (int index = 0; index < count; ++index) {
-                totalVel += vels[index];
-            }
-            
-            return totalVel / static_cast<float>(count);
-        }
-    };
-    
-    //------------------------------------------------------------------------------
-    /// aCharaB より aCharaA が上位かどうかを返します。
-    bool IsHighOrder(const Chara& aCharaA, const Chara& aCharaB)
-    {
         // ゴールしている方が上位
-        if (aCharaA.isGoal() && !aCharaB.isGoal()) {
+        if (isGoalA && !isGoalB) {
             return true;
         }
-        if (!aCharaA.isGoal() && aCharaB.isGoal()) {
+        if (!isGoalA && isGoalB) {
             return false;
         }
         
         // 両方ゴールしている場合
-        if (aCharaA.isGoal() && aCharaB.isGoal()) {
+        if (isGoalA && isGoalB) {
             // ゴールまでのターン数が短い方が上位
-            return aCharaA.passedTurn() < aCharaB.passedTurn();
+            return aBlock.passedTurn[aIndexA] < aBlock.passedTurn[aIndexB];
         }
         
         // 両方ゴールしていない場合
-        if (!aCharaA.isGoal() && !aCharaB.isGoal()) {
+        if (!isGoalA && !isGoalB) {
             // 通過した蓮の数が多い方が上位
-            return aCharaB.passedLotusCount() < aCharaA.passedLotusCount();
+            return aBlock.passedLotusCount(aIndexB, aLotusCount) < aBlock.passedLotusCount(aIndexA, aLotusCount);
         }
         
         HPC_SHOULD_NOT_REACH_HERE();
@@ -89,10 +55,14 @@ namespace hpc {
     //------------------------------------------------------------------------------
     /// クラスのインスタンスを生成します。
     CharaCollection::CharaCollection()
-        : mCharas()
+        : mHotBlock()
+        , mCharas()
         , mCharaTypes()
         , mCount(0)
     {
+        for (int index = 0; index < Parameter::CharaCountMax; ++index) {
+            mCharas[index].setupHotBlock(mHotBlock, index);
+        }
     }
 
     //------------------------------------------------------------------------------
@@ -100,171 +70,84 @@ namespace hpc {
     void CharaCollection::procDecideAction(Random& aRandom)
     {
         for (int index = 0; index < count(); ++index) {
-            Chara& chara = mCharas[index];
-            
             // ゴールしていたら何もしない
-            if (chara.isGoal()) {
+            if (mHotBlock.isGoal(index)) {
                 continue;
             }
             
-            chara.decideAction(aRandom);
+            mCharas[index].decideAction(aRandom);
         }
     }
 
     //------------------------------------------------------------------------------
-    /// 各キャラの動作を実行します。
-    void CharaCollection::procExecAction()
+    /// 各キャラの動作を、 Brain に問い合わせずに指定します。
+    ///
+    /// @param[in] aActions 各キャラの動作。 count() 個の要素が必要です。
+    void CharaCollection::procSetAction(const Action* aActions)
     {
         for (int index = 0; index < count(); ++index) {
-            Chara& chara = mCharas[index];
-            
             // ゴールしていたら何もしない
-            if (chara.isGoal()) {
+            if (mHotBlock.isGoal(index)) {
                 continue;
             }
             
-            chara.execAction();
-            
-            // 移動処理を行う
-            chara.move();
+            mCharas[index].setAction(aActions[index]);
         }
     }
 
     //------------------------------------------------------------------------------
-    /// 各キャラ同士の衝突判定を行います。
-    void CharaCollection::procCheckColl()
+    /// 各キャラの動作を実行します。
+    void CharaCollection::procExecAction(const Stage& aStage)
     {
-        // ■衝突判定の方針について
-        // 条件：静止円同士での判定。非弾性衝突。処理順に影響しない。
-        // 
-        // 1. 各々の現在位置で衝突しているかをチェックする。
-        // 2. 衝突している場合、現フレームの位置関係で衝突したと仮定し、互いの速度ベクトルを求める。
-        // 3. 互いのめり込みを補正する為のベクトルを求める。
-        // 4. 全てのキャラ同士で1. 2. 3. の判定を行い、求めた速度ベクトルの平均値を最終的な速度ベクトル、
-        //    求めためり込み補正ベクトルの合計を、最終的な補正ベクトルとする。
-        // 5. めり込み補正を行う。
-        // 6. フィールド外に出ていたら、座標を内側に補正し、速度ベクトルをゼロにする。
-        // (以上の処理を行った後、各種判定を行う)
-        // 
-        // ※注意点
-        // 正確さよりもをシンプルさを優先している為、衝突の仕方によっては
-        // 不自然な方向に跳ね返る事があります。
-        
-        CalcVelSet velSet[Parameter::CharaCountMax];
-        
-        for (int indexA = 0; indexA < count(); ++indexA) {
-            const Chara& charaA = mCharas[indexA];
-            
-            // ゴールしていたら何もしない
-            if (charaA.isGoal()) {
-                continue;
-            }
-            
-            const Vec2 velA = charaA.vel();
-            const Circle circleA = charaA.region();
-            
-            for (int indexB = indexA + 1; indexB < count(); ++indexB) {
-                const Chara& charaB = mCharas[indexB];
-                
-                // ゴールしていたら何もしない
-                if (charaB.isGoal()) {
-                    continue;
-                }
-                
-                const Vec2 velB = charaB.vel();
-                const Circle circleB = charaB.region();
-                
-                if (Collision::IsHit(circleA, circleB)) {
-                    
-                    Vec2 toB = charaB.pos() - charaA.pos();
-                    const float margin = Parameter::CharaDecelSpeed();
-                    const float separateHalfDist = (circleA.radius() + circleB.radius() - toB.length() + margin) / 2.0f;
-                    // 完全に重なっていたら、x軸と水平に衝突したことにする
-                    if (toB.isZero()) {
-                        toB.x = 1.0f;
-                    }
-                    
-                    const Vec2 verticalA = velA.getProjected(toB);
-                    const Vec2 parallelA = velA - verticalA;
-                    const Vec2 verticalB = velB.getProjected(toB);
-                    const Vec2 parallelB = velB - verticalB;
-                    
-                    const float factor = Parameter::CharaReflectionFactor();
-                    const Vec2 nextVerticalA = (verticalA * (1.0f - factor) + verticalB * (1.0f + factor)) / 2.0f;
-                    const Vec2 nextVerticalB = nextVerticalA - (verticalB - verticalA) * factor;
-                    
-                    const Vec2 ofsSeparateVec = 0.0f < separateHalfDist
-                        ? toB.getNormalized(separateHalfDist)
-                        : Vec2();
-                    velSet[indexA].addVel(parallelA + nextVerticalA, -ofsSeparateVec);
-                    velSet[indexB].addVel(parallelB + nextVerticalB, ofsSeparateVec);
-                }
-            }
-        }
-        
-        // 求めた結果を反映する
+        ProfileProbe probe(aStage.profiler(), ProfilePhase_ExecAction);
+        const Vec2 flowVel = aStage.field().flowVel();
         for (int index = 0; index < count(); ++index) {
-            Chara& chara = mCharas[index];
-            
             // ゴールしていたら何もしない
-            if (chara.isGoal()) {
+            if (mHotBlock.isGoal(index)) {
                 continue;
             }
             
-            // 衝突していなかったら何もしない
-            if (velSet[index].count == 0) {
-                continue;
-            }
-            chara.setVel(velSet[index].calculatedVel());
+            mCharas[index].execAction();
             
-            // めりこみ補正を反映させる
-            chara.separation(velSet[index].ofsSeparateVec);
-        }
-        
-        // フィールド外に出ていたら、内側に補正する
-        for (int index = 0; index < count(); ++index) {
-            Chara& chara = mCharas[index];
-            
-            // ゴールしていたら何もしない
-            if (chara.isGoal()) {
-                continue;
-            }
-            
-            chara.correctInside();
+            // 移動処理を行う
+            mHotBlock.move(index, flowVel);
         }
     }
 
+    //------------------------------------------------------------------------------
+    /// 各キャラ同士の衝突判定を行います。
+    void CharaCollection::procCheckColl(const Stage& aStage)
+    {
+        ProfileProbe probe(aStage.profiler(), ProfilePhase_CheckColl);
+        mHotBlock.checkColl(count(), aStage.field().rect());
+    }
+
     //------------------------------------------------------------------------------
     /// 最終処理を行います。
     void CharaCollection::procEnd(const Stage& aStage)
     {
-        for (int index = 0; index < count(); ++index) {
-            Chara& chara = mCharas[index];
-            
-            // ゴールしていたら何もしない
-            if (chara.isGoal()) {
-                continue;
-            }
-            
-            // ターン経過処理を行う
-            chara.updateTurn();
-            
-            // 蓮の通過判定
-            while (!chara.isGoal()) {
-                const Lotus& lotus = aStage.lotuses()[chara.targetLotusNo()];
-                // 円（蓮）と移動円（キャラの前回位置から今回位置への移動）で衝突判定を行う
-                if (Collision::IsHit(lotus.region(), chara.prevRegion(), chara.region().pos())) {
-                    // 目標の蓮を通過したら、次の蓮との判定を行う
-                    chara.incTargetLotusNo();
-                } else {
-                    // 目標の蓮を通過していなかったら判定終了
-                    break;
+        const LotusCollection& lotuses = aStage.lotuses();
+        {
+            ProfileProbe probe(aStage.profiler(), ProfilePhase_End);
+            for (int index = 0; index < count(); ++index) {
+                // ゴールしていたら何もしない
+                if (mHotBlock.isGoal(index)) {
+                    continue;
                 }
+                
+                // ターン経過処理を行う
+                mHotBlock.updateTurn(index);
+                
+                // 蓮の通過判定
+                mHotBlock.passLotus(index, lotuses);
             }
         }
         
         // 順位を更新
-        updateRank();
+        {
+            ProfileProbe probe(aStage.profiler(), ProfilePhase_UpdateRank);
+            updateRank(lotuses.count());
+        }
     }
 
     //------------------------------------------------------------------------------
@@ -311,7 +194,7 @@ namespace hpc {
                 continue;
             }
             
-            if (!mCharas[index].isGoal()) {
+            if (!mHotBlock.isGoal(index)) {
                 return false;
             }
             
@@ -333,7 +216,7 @@ namespace hpc {
         int targetCount = 0;
         
         for (int index = 0; index < count(); ++index) {
-            if (mCharas[index].isGoal()) {
+            if (mHotBlock.isGoal(index)) {
                 ++targetCount;
             }
         }
@@ -361,32 +244,66 @@ namespace hpc {
         return mCharas[aIndex];
     }
 
+    //------------------------------------------------------------------------------
+    /// @return 全キャラの位置や速度など、移動計算で参照する状態。
+    const CharaHotBlock& CharaCollection::hotBlock()const
+    {
+        return mHotBlock;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各キャラの状態を保存します。
+    ///
+    /// @param[out] aHotBlock 移動計算で参照する状態の保存先。
+    /// @param[out] aBrains   動作決定モジュールの保存先。 Parameter::CharaCountMax 個の要素が必要です。
+    ///                       プレイヤーの戦略は保存しません。
+    void CharaCollection::save(CharaHotBlock& aHotBlock, Brain* aBrains)const
+    {
+        aHotBlock = mHotBlock;
+        for (int index = 0; index < count(); ++index) {
+            mCharas[index].brain().save(aBrains[index]);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// save で保存した状態に戻します。
+    ///
+    /// @param[in] aHotBlock 移動計算で参照する状態。
+    /// @param[in] aBrains   動作決定モジュールの状態。
+    void CharaCollection::restore(const CharaHotBlock& aHotBlock, const Brain* aBrains)
+    {
+        mHotBlock = aHotBlock;
+        for (int index = 0; index < count(); ++index) {
+            mCharas[index].restoreBrain(aBrains[index]);
+        }
+    }
+
     //------------------------------------------------------------------------------
     /// 順位を更新します。
-    void CharaCollection::updateRank()
+    ///
+    /// @param[in] aLotusCount ステージの蓮の数。
+    void CharaCollection::updateRank(int aLotusCount)
     {
-        Chara* charaArray[Parameter::CharaCountMax] = {0};
+        int orderArray[Parameter::CharaCountMax] = {0};
         
         for (int index = 0; index < count(); ++index) {
-            charaArray[index] = &mCharas[index];
+            orderArray[index] = index;
         }
         
         // 順位決定
         for (int indexA = 0; indexA < count(); ++indexA) {
-            HPC_ASSERT(charaArray[indexA] != 0);
             for (int indexB = indexA + 1; indexB < count(); ++indexB) {
-                HPC_ASSERT(charaArray[indexB] != 0);
-                if (IsHighOrder(*charaArray[indexB], *charaArray[indexA])) {
-                    Chara* tmp = charaArray[indexA];
-                    charaArray[indexA] = charaArray[indexB];
-                    charaArray[indexB] = tmp;
+                if (IsHighOrder(mHotBlock, orderArray[indexB], orderArray[indexA], aLotusCount)) {
+                    const int tmp = orderArray[indexA];
+                    orderArray[indexA] = orderArray[indexB];
+                    orderArray[indexB] = tmp;
                 }
             }
         }
         
         // 結果を反映
         for (int index = 0; index < count(); ++index) {
-            charaArray[index]->setRank(index);
+            mHotBlock.rank[orderArray[index]] = index;
         }
     }
 }
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "HPCChara.hpp"
+#include "HPCCharaHotBlock.hpp"
 #include "HPCParameter.hpp"
 #include "HPCVec2.hpp"
 
@@ -23,6 +24,8 @@ namespace hpc {
     /// キャラの組を表します。
     ///
     /// 1ステージのすべてのキャラは、この CharaCollection クラスに格納されます。
+    /// 位置や速度など毎ターンの移動計算で参照する値は CharaHotBlock にまとめて持ち、
+    /// 各キャラはそこを参照します。
     /// このクラスは、回答者には公開されません。
     class CharaCollection
     {
@@ -30,8 +33,9 @@ namespace hpc {
         CharaCollection();
 
         void procDecideAction(Random& aRandom);         ///< 動作を決定します。
-        void procExecAction();                          ///< 動作を実行します。
-        void procCheckColl();                           ///< キャラ同士の衝突判定を行います。
+        void procSetAction(const Action* aActions);     ///< 動作を指定します。
+        void procExecAction(const Stage& aStage);       ///< 動作を実行します。
+        void procCheckColl(const Stage& aStage);        ///< キャラ同士の衝突判定を行います。
         void procEnd(const Stage& aStage);              ///< 最終処理を行います。
         
         void reset();                                   ///< キャラデータを初期化します。
@@ -50,12 +54,21 @@ namespace hpc {
         Chara& operator[](int aIndex);
         //@}
 
+        const CharaHotBlock& hotBlock()const;           ///< 移動計算で参照する状態を返します。
+        void save(CharaHotBlock& aHotBlock, Brain* aBrains)const;           ///< 状態を保存します。
+        void restore(const CharaHotBlock& aHotBlock, const Brain* aBrains); ///< 状態を復元します。
+
     private:
+        CharaHotBlock mHotBlock;                        ///< 移動計算で参照する状態
         Chara mCharas[Parameter::CharaCountMax];        ///< キャラ用配列
         CharaType mCharaTypes[Parameter::CharaCountMax];///< キャラの種類
         int mCount;                                     ///< 有効なキャラ数
         
-        void updateRank();
+        void updateRank(int aLotusCount);
+
+        // 各キャラが mHotBlock を参照しているため、コピーは禁止します。
+        CharaCollection(const CharaCollection&);
+        CharaCollection& operator=(const CharaCollection&);
     };
 }
 //------------------------------------------------------------------------------
@@ -0,0 +1,334 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCCharaHotBlock.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCCharaHotBlock.hpp"
+
+#include "HPCCircle.hpp"
+#include "HPCCollision.hpp"
+#include "HPCCommon.hpp"
+#include "HPCLotusCollection.hpp"
+#include "HPCMath.hpp"
+#include "HPCMoveKernel.hpp"
+
+namespace {
+    using namespace hpc;
+    
+    //------------------------------------------------------------------------------
+    /// 速度ベクトル計算用構造体
+    struct CalcVelSet
+    {
+        Vec2 vels[Parameter::CharaCountMax];
+        Vec2 ofsSeparateVec;
+        int count;
+
+        CalcVelSet()
+            : vels()
+            , ofsSeparateVec()
+            , count(0)
+        {
+        }
+        
+        void addVel(const Vec2& aVel, const Vec2& aOfsSeparateVec)
+        {
+            HPC_ASSERT(count < Parameter::CharaCountMax);
+            vels[count++] = aVel;
+            ofsSeparateVec += aOfsSeparateVec;
+        }
+        
+        Vec2 calculatedVel()const
+        {
+            if (count == 0) {
+                return Vec2();
+            }
+            
+            Vec2 totalVel;
+            for (int index = 0; index < count; ++index) {
+                totalVel += vels[index];
+            }
+            
+            return totalVel / static_cast<float>(count);
+        }
+    };
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// インスタンスを生成します。すべてのキャラの状態を初期化します。
+    CharaHotBlock::CharaHotBlock()
+        : pos()
+        , prevPos()
+        , vel()
+        , accelCount()
+        , accelWaitTurn()
+        , accelWaitTurnMax()
+        , targetLotusNo()
+        , roundCount()
+        , rank()
+        , passedTurn()
+    {
+        for (int index = 0; index < Parameter::CharaCountMax; ++index) {
+            reset(index);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex キャラのインデックス。
+    void CharaHotBlock::reset(int aIndex)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, Parameter::CharaCountMax);
+        pos[aIndex].reset();
+        prevPos[aIndex].reset();
+        vel[aIndex].reset();
+        accelCount[aIndex] = Parameter::CharaInitAccelCount;
+        accelWaitTurn[aIndex] = Parameter::CharaAddAccelWaitTurn;
+        accelWaitTurnMax[aIndex] = Parameter::CharaAddAccelWaitTurn;
+        targetLotusNo[aIndex] = 0;
+        roundCount[aIndex] = 0;
+        rank[aIndex] = 0;
+        passedTurn[aIndex] = 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 加速できるなら、目標座標の方向へ一定の速さを設定します。
+    ///
+    /// @param[in] aIndex     キャラのインデックス。
+    /// @param[in] aTargetPos 目標座標。
+    void CharaHotBlock::accel(int aIndex, const Vec2& aTargetPos)
+    {
+        // 加速可能回数がゼロの場合、何もしない
+        if (accelCount[aIndex] <= 0) {
+            return;
+        }
+        
+        const Vec2 toTargetVec = aTargetPos - pos[aIndex];
+        
+        // 目標座標とキャラ座標が同値の場合、何もしない
+        if (toTargetVec.isZero()) {
+            return;
+        }
+        
+        --accelCount[aIndex];
+        
+        // 目標座標方向への一定加速度を設定する（加算ではなく、上書き）
+        vel[aIndex] = toTargetVec.getNormalized(Parameter::CharaAccelSpeed());
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex   キャラのインデックス。
+    /// @param[in] aFlowVel フィールドの流れる速度。
+    void CharaHotBlock::move(int aIndex, const Vec2& aFlowVel)
+    {
+        MoveKernel::Move(&pos[aIndex], &vel[aIndex], 1, aFlowVel);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex キャラのインデックス。
+    void CharaHotBlock::updateTurn(int aIndex)
+    {
+        HPC_ASSERT(!isGoal(aIndex));
+        
+        ++passedTurn[aIndex];
+        --accelWaitTurn[aIndex];
+        if (accelWaitTurn[aIndex] <= 0) {
+            accelCount[aIndex] = Math::Min(accelCount[aIndex] + 1, Parameter::CharaAccelCountMax);
+            accelWaitTurn[aIndex] = accelWaitTurnMax[aIndex];
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// フィールド外に出ていた場合、座標補正と同時に速度がゼロになります。
+    ///
+    /// @param[in] aIndex     キャラのインデックス。
+    /// @param[in] aFieldRect フィールドの範囲。
+    void CharaHotBlock::correctInside(int aIndex, const Rectangle& aFieldRect)
+    {
+        Vec2 myPos = pos[aIndex];
+        const float radius = Parameter::CharaRadius();
+        bool isCorrect = false;
+        
+        if (myPos.x - radius < aFieldRect.left) {
+            myPos.x = aFieldRect.left + radius;
+            isCorrect = true;
+        } else if (aFieldRect.right < myPos.x + radius) {
+            myPos.x = aFieldRect.right - radius;
+            isCorrect = true;
+        }
+        if (myPos.y - radius < aFieldRect.bottom) {
+            myPos.y = aFieldRect.bottom + radius;
+            isCorrect = true;
+        } else if (aFieldRect.top < myPos.y + radius) {
+            myPos.y = aFieldRect.top - radius;
+            isCorrect = true;
+        }
+        
+        if (isCorrect) {
+            pos[aIndex] = myPos;
+            vel[aIndex].reset();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 先頭の aCount 体のキャラ同士の衝突判定を行い、フィールドの内側に補正します。
+    ///
+    /// @param[in] aCount     有効なキャラ数。
+    /// @param[in] aFieldRect フィールドの範囲。
+    void CharaHotBlock::checkColl(int aCount, const Rectangle& aFieldRect)
+    {
+        // ■衝突判定の方針について
+        // 条件：静止円同士での判定。非弾性衝突。処理順に影響しない。
+        // 
+        // 1. 各々の現在位置で衝突しているかをチェックする。
+        // 2. 衝突している場合、現フレームの位置関係で衝突したと仮定し、互いの速度ベクトルを求める。
+        // 3. 互いのめり込みを補正する為のベクトルを求める。
+        // 4. 全てのキャラ同士で1. 2. 3. の判定を行い、求めた速度ベクトルの平均値を最終的な速度ベクトル、
+        //    求めためり込み補正ベクトルの合計を、最終的な補正ベクトルとする。
+        // 5. めり込み補正を行う。
+        // 6. フィールド外に出ていたら、座標を内側に補正し、速度ベクトルをゼロにする。
+        // (以上の処理を行った後、各種判定を行う)
+        // 
+        // ※注意点
+        // 正確さよりもをシンプルさを優先している為、衝突の仕方によっては
+        // 不自然な方向に跳ね返る事があります。
+        
+        CalcVelSet velSet[Parameter::CharaCountMax];
+        
+        for (int indexA = 0; indexA < aCount; ++indexA) {
+            // ゴールしていたら何もしない
+            if (isGoal(indexA)) {
+                continue;
+            }
+            
+            const Vec2 velA = vel[indexA];
+            const Circle circleA(pos[indexA], Parameter::CharaRadius());
+            
+            for (int indexB = indexA + 1; indexB < aCount; ++indexB) {
+                // ゴールしていたら何もしない
+                if (isGoal(indexB)) {
+                    continue;
+                }
+                
+                const Vec2 velB = vel[indexB];
+                const Circle circleB(pos[indexB], Parameter::CharaRadius());
+                
+                if (Collision::IsHit(circleA, circleB)) {
+                    
+                    Vec2 toB = circleB.pos() - circleA.pos();
+                    const float margin = Parameter::CharaDecelSpeed();
+                    const float separateHalfDist = (circleA.radius() + circleB.radius() - toB.length() + margin) / 2.0f;
+                    // 完全に重なっていたら、x軸と水平に衝突したことにする
+                    if (toB.isZero()) {
+                        toB.x = 1.0f;
+                    }
+                    
+                    const Vec2 verticalA = velA.getProjected(toB);
+                    const Vec2 parallelA = velA - verticalA;
+                    const Vec2 verticalB = velB.getProjected(toB);
+                    const Vec2 parallelB = velB - verticalB;
+                    
+                    const float factor = Parameter::CharaReflectionFactor();
+                    const Vec2 nextVerticalA = (verticalA * (1.0f - factor) + verticalB * (1.0f + factor)) / 2.0f;
+                    const Vec2 nextVerticalB = nextVerticalA - (verticalB - verticalA) * factor;
+                    
+                    const Vec2 ofsSeparateVec = 0.0f < separateHalfDist
+                        ? toB.getNormalized(separateHalfDist)
+                        : Vec2();
+                    velSet[indexA].addVel(parallelA + nextVerticalA, -ofsSeparateVec);
+                    velSet[indexB].addVel(parallelB + nextVerticalB, ofsSeparateVec);
+                }
+            }
+        }
+        
+        // 求めた結果を反映する
+        for (int index = 0; index < aCount; ++index) {
+            // ゴールしていたら何もしない
+            if (isGoal(index)) {
+                continue;
+            }
+            
+            // 衝突していなかったら何もしない
+            if (velSet[index].count == 0) {
+                continue;
+            }
+            vel[index] = velSet[index].calculatedVel();
+            
+            // めりこみ補正を反映させる
+            pos[index] += velSet[index].ofsSeparateVec;
+        }
+        
+        // フィールド外に出ていたら、内側に補正する
+        for (int index = 0; index < aCount; ++index) {
+            // ゴールしていたら何もしない
+            if (isGoal(index)) {
+                continue;
+            }
+            
+            correctInside(index, aFieldRect);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 今回の移動で目標の蓮を通過していたら、次に目指す蓮を進めます。
+    /// 1ターンで複数の蓮を通過することもあります。
+    ///
+    /// @param[in] aIndex   キャラのインデックス。
+    /// @param[in] aLotuses ステージの蓮。
+    void CharaHotBlock::passLotus(int aIndex, const LotusCollection& aLotuses)
+    {
+        const Circle prevRegion(prevPos[aIndex], Parameter::CharaRadius());
+        while (!isGoal(aIndex)) {
+            const Lotus& lotus = aLotuses[targetLotusNo[aIndex]];
+            // 円（蓮）と移動円（キャラの前回位置から今回位置への移動）で衝突判定を行う
+            if (Collision::IsHit(lotus.region(), prevRegion, pos[aIndex])) {
+                // 目標の蓮を通過したら、次の蓮との判定を行う
+                incTargetLotusNo(aIndex, aLotuses.count());
+            } else {
+                // 目標の蓮を通過していなかったら判定終了
+                break;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex      キャラのインデックス。
+    /// @param[in] aLotusCount ステージの蓮の数。
+    void CharaHotBlock::incTargetLotusNo(int aIndex, int aLotusCount)
+    {
+        ++targetLotusNo[aIndex];
+        // 一周回ったら周回数加算
+        if (aLotusCount == targetLotusNo[aIndex]) {
+            targetLotusNo[aIndex] = 0;
+            ++roundCount[aIndex];
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex キャラのインデックス。
+    ///
+    /// @return ゴールしたか
+    bool CharaHotBlock::isGoal(int aIndex)const
+    {
+        return roundCount[aIndex] == Parameter::StageRoundCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex      キャラのインデックス。
+    /// @param[in] aLotusCount ステージの蓮の数。
+    ///
+    /// @return 通過した蓮の数
+    int CharaHotBlock::passedLotusCount(int aIndex, int aLotusCount)const
+    {
+        return roundCount[aIndex] * aLotusCount + targetLotusNo[aIndex];
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    CharaHotBlock 構造体
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCParameter.hpp"
+#include "HPCRectangle.hpp"
+#include "HPCVec2.hpp"
+
+namespace hpc {
+
+    class LotusCollection;
+
+    //------------------------------------------------------------------------------
+    /// キャラの状態のうち、毎ターンの移動計算で参照する値をまとめたものです。
+    ///
+    /// 値の種類ごとにキャラ数分の配列を持つので、 CharaCollection の各処理は
+    /// Brain などの大きなデータを経由せず、小さな配列だけを走査できます。
+    /// ポインタを含まないため、そのままコピーして状態を保存できます。
+    /// キャラの半径はすべて Parameter::CharaRadius() です。
+    struct CharaHotBlock
+    {
+        CharaHotBlock();
+
+        void reset(int aIndex);                             ///< aIndex 番目のキャラの状態を初期化します。
+
+        /// @name 移動計算
+        //@{
+        void accel(int aIndex, const Vec2& aTargetPos);     ///< 加速できるなら加速します。
+        void move(int aIndex, const Vec2& aFlowVel);        ///< 移動処理を行います。
+        void updateTurn(int aIndex);                        ///< ターン経過処理を行います。
+        void correctInside(int aIndex, const Rectangle& aFieldRect); ///< フィールドの内側に補正します。
+        void checkColl(int aCount, const Rectangle& aFieldRect);    ///< キャラ同士の衝突判定を行います。
+        void passLotus(int aIndex, const LotusCollection& aLotuses); ///< 蓮の通過判定を行います。
+        void incTargetLotusNo(int aIndex, int aLotusCount); ///< 次に目指す蓮の番号を１つ進めます。
+        //@}
+
+        bool isGoal(int aIndex)const;                       ///< ゴールしたかどうかを返します。
+        int passedLotusCount(int aIndex, int aLotusCount)const; ///< 通過した蓮の数を返します。
+
+        Vec2 pos[Parameter::CharaCountMax];                 ///< 現在位置
+        Vec2 prevPos[Parameter::CharaCountMax];             ///< 前回位置
+        Vec2 vel[Parameter::CharaCountMax];                 ///< 速度
+        int accelCount[Parameter::CharaCountMax];           ///< 加速できる回数
+        int accelWaitTurn[Parameter::CharaCountMax];        ///< 加速回数が増えるまでの残りターン数
+        int accelWaitTurnMax[Parameter::CharaCountMax];     ///< 加速回数が増えるまでの残りターン数 の設定値
+        int targetLotusNo[Parameter::CharaCountMax];        ///< 現在の目指す蓮番号
+        int roundCount[Parameter::CharaCountMax];           ///< 周回数
+        int rank[Parameter::CharaCountMax];                 ///< 順位
+        int passedTurn[Parameter::CharaCountMax];           ///< 経過ターン数
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
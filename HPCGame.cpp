@@ -11,8 +11,11 @@
 
 #include "HPCGame.hpp"
 
+#include <cstring>
 #include "HPCCommon.hpp"
 #include "HPCLevelDesigner.hpp"
+#include "HPCProfileProbe.hpp"
+#include "HPCProfiler.hpp"
 
 namespace hpc {
 
@@ -25,7 +28,10 @@ namespace hpc {
         , mStage()
         , mCurrentStageIndex(0)
         , mRecord()
+        , mProfiler(0)
+        , mAnswerState()
     {
+        mStage.setAnswerState(mAnswerState);
     }
 
     //------------------------------------------------------------------------------
@@ -37,11 +43,20 @@ namespace hpc {
         HPC_ASSERT_MSG(isValidStage(), "Index indicates an invalid Stage (#%d)", mCurrentStageIndex);
         
         // ステージの生成を行います。
+        // 乱数列はステージごとに設定し直すので、前のステージの結果には依存しません。
+        if (mProfiler) {
+            mProfiler->beginStage(mCurrentStageIndex);
+        }
+        mRandSet.setupStage(mCurrentStageIndex);
         LevelDesigner::Setup(mCurrentStageIndex, mStage, mRandSet.system());
 
+        mStage.timeBudget().startStage(mCurrentStageIndex);
         mStage.start();
         mRecord.writeStartStage(mCurrentStageIndex, mStage);
-        mRecord.writeTurn(mStage.lastTurnResult());
+        {
+            ProfileProbe probe(mProfiler, ProfilePhase_RecordWriteTurn);
+            mRecord.writeTurn(mStage.lastTurnResult());
+        }
     }
 
     //------------------------------------------------------------------------------
@@ -53,7 +68,10 @@ namespace hpc {
         HPC_ASSERT_MSG(isValidStage(), "Index indicates an invalid Stage (#%d)", mCurrentStageIndex);
 
         mStage.runTurn(mRandSet.game());
-        mRecord.writeTurn(mStage.lastTurnResult());
+        {
+            ProfileProbe probe(mProfiler, ProfilePhase_RecordWriteTurn);
+            mRecord.writeTurn(mStage.lastTurnResult());
+        }
     }
 
     //------------------------------------------------------------------------------
@@ -76,9 +94,33 @@ namespace hpc {
     {
         HPC_ASSERT_MSG(isValidStage(), "Index indicates an invalid Stage (#%d)", mCurrentStageIndex);
         mRecord.writeEndStage(mStage);
+        mStage.timeBudget().endStage();
+        if (mProfiler) {
+            mProfiler->endStage();
+        }
         ++mCurrentStageIndex;
     }
 
+    //------------------------------------------------------------------------------
+    /// すべてのステージを実行し終えたときに、ゲームが終了したことを通知するために呼び出します。
+    void Game::onGameDone()
+    {
+        mRecord.writeEndGame();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 次に startStage() で開始するステージを選択します。
+    ///
+    /// 各ステージの乱数列はステージ番号から決まるため、
+    /// 前のステージを実行せずに任意のステージから開始することができます。
+    ///
+    /// @param[in] aStageIndex ステージ番号。
+    void Game::selectStage(int aStageIndex)
+    {
+        mCurrentStageIndex = aStageIndex;
+        HPC_ASSERT_MSG(isValidStage(), "Index indicates an invalid Stage (#%d)", mCurrentStageIndex);
+    }
+
     //------------------------------------------------------------------------------
     /// 内部で示されるステージ番号が有効な範囲を指しているかどうかを取得します。
     ///
@@ -92,6 +134,102 @@ namespace hpc {
         return (0 <= mCurrentStageIndex && mCurrentStageIndex < Parameter::GameStageCount);
     }
 
+    //------------------------------------------------------------------------------
+    /// @return 現在のステージ番号。すべてのステージを終えた後は無効な値になります。
+    int Game::stageIndex()const
+    {
+        return mCurrentStageIndex;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 他のワーカーで実行したステージの記録を、このゲームの記録に書き込みます。
+    ///
+    /// @param[in] aStageIndex   ステージ番号。
+    /// @param[in] aRecordStage  ステージの記録。
+    void Game::writeStageRecord(int aStageIndex, const RecordStage& aRecordStage)
+    {
+        mRecord.writeStage(aStageIndex, aRecordStage);
+    }
+
+    //------------------------------------------------------------------------------
+    /// リプレイファイルから読み込んだ記録で、このゲームの記録を置き換えます。
+    ///
+    /// @param[in,out] aReader 読み込み元。
+    ///
+    /// @return 正しく読み込めた場合は @c true を返します。
+    bool Game::readRecord(ReplayReader& aReader)
+    {
+        return mRecord.readReplay(aReader);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 記録の送り先を設定します。
+    ///
+    /// @param[in] aSink 記録の送り先。 0 を指定すると、メモリに記録します。
+    void Game::setRecordSink(RecordSink* aSink)
+    {
+        mRecord.setSink(aSink);
+    }
+
+    //------------------------------------------------------------------------------
+    /// プレイヤーの動作を決める戦略を設定します。
+    ///
+    /// @param[in] aStrategy 戦略。 0 を指定すると Answer を直接呼び出します。
+    void Game::setPlayerStrategy(StrategyInstance* aStrategy)
+    {
+        mStage.setPlayerStrategy(aStrategy);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 集計先は Stage にも設定され、各キャラの処理時間もそこに集計されます。
+    /// 集計しない場合、 ProfileProbe は時刻を読まずに何もしません。
+    ///
+    /// @param[in] aProfiler 集計先。 0 を指定すると集計しません。既定値は 0 です。
+    void Game::setProfiler(Profiler* aProfiler)
+    {
+        mProfiler = aProfiler;
+        mStage.setProfiler(aProfiler);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージを実行する前に呼び出し、記録の準備をします。
+    ///
+    /// ステージをワーカーで並列に実行する場合は、ワーカーを起動する前に呼び出す必要があります。
+    void Game::setupRecord()
+    {
+        mRecord.setupTurnBuffer();
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージを実行する前に呼び出し、解答の状態の領域をゼロで初期化します。
+    /// 解答からは StageAccessor::answerState() で参照できます。
+    void Game::setupAnswerState()
+    {
+        std::memset(mAnswerState, 0, sizeof(mAnswerState));
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージを実行する前に呼び出し、残り時間の見積もりの準備をします。
+    /// 回答からは StageAccessor::timeBudget() で参照できます。
+    ///
+    /// @param[in] aTimer      計測を開始した、ゲームの制限時間を計測するタイマー。
+    /// @param[in] aStageBegin このゲームで最初に実行するステージ番号。
+    /// @param[in] aStageEnd   このゲームで最後に実行するステージ番号 + 1。
+    /// @param[in] aStageStep  実行するステージ番号の間隔。
+    void Game::setupTimeBudget(const Timer& aTimer, int aStageBegin, int aStageEnd, int aStageStep)
+    {
+        mStage.timeBudget().setup(aTimer, aStageBegin, aStageEnd, aStageStep);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 回答からは StageAccessor::timeBudget() の TimeBudget::isDeadlineEnabled() で参照できます。
+    ///
+    /// @param[in] aIsEnabled 締め切りを使わせる場合は @c true 。既定値は @c false です。
+    void Game::setDeadlineEnabled(bool aIsEnabled)
+    {
+        mStage.timeBudget().setDeadlineEnabled(aIsEnabled);
+    }
+
     //------------------------------------------------------------------------------
     /// 内部に格納されているゲームの記録を返します。
     ///
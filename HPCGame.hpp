@@ -14,6 +14,7 @@
 #include "HPCRandomSet.hpp"
 #include "HPCRecord.hpp"
 #include "HPCStage.hpp"
+#include "HPCStageAccessor.hpp"
 
 namespace hpc {
 
@@ -28,7 +29,23 @@ namespace hpc {
         void runTurn();                     ///< 現在実行中のステージでターンを1つ進めます。
         StageState state()const;           ///< ステージ内での現在の状態を表します。
         void onStageDone();                 ///< ステージ終了を通知します。
+        void onGameDone();                  ///< ゲーム終了を通知します。
+        void selectStage(int aStageIndex);  ///< 次に開始するステージを選択します。
         bool isValidStage()const;          ///< 現在のステージが有効なものかどうかを返します。
+        int stageIndex()const;             ///< 現在のステージ番号を返します。
+
+        /// 他のワーカーで実行したステージの記録を書き込みます。
+        void writeStageRecord(int aStageIndex, const RecordStage& aRecordStage);
+        /// リプレイファイルから記録を読み込みます。
+        bool readRecord(ReplayReader& aReader);
+        void setRecordSink(RecordSink* aSink);  ///< 記録の送り先を設定します。
+        void setPlayerStrategy(StrategyInstance* aStrategy);    ///< プレイヤーの戦略を設定します。
+        void setProfiler(Profiler* aProfiler);  ///< 処理時間の集計先を設定します。
+        void setupRecord();                 ///< ステージを実行する前に記録の準備をします。
+        void setupAnswerState();            ///< ステージを実行する前に解答の状態を初期化します。
+        /// ステージを実行する前に残り時間の見積もりの準備をします。
+        void setupTimeBudget(const Timer& aTimer, int aStageBegin, int aStageEnd, int aStageStep);
+        void setDeadlineEnabled(bool aIsEnabled);   ///< 回答に各ターンの締め切りを使わせるかを設定します。
 
         const Record& record()const;       ///< 記録へのアクセサ
 
@@ -37,6 +54,13 @@ namespace hpc {
         Stage mStage;                       ///< ステージ
         int mCurrentStageIndex;             ///< 現在のステージ番号
         Record mRecord;                     ///< 記録
+        Profiler* mProfiler;                ///< 処理時間の集計先。集計しなければ 0
+        /// 解答の状態の領域。どの型でも置けるよう double の配列で持ちます
+        double mAnswerState[StageAccessor::AnswerStateSize / sizeof(double)];
+
+        // 解答の状態の領域を Stage が参照しているため、コピーは禁止します。
+        Game(const Game&);
+        Game& operator=(const Game&);
     };
 }
 //------------------------------------------------------------------------------
@@ -0,0 +1,196 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCJsonWriter.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCJsonWriter.hpp"
+
+#include <cmath>
+#include <cstring>
+#include "HPCCommon.hpp"
+#include "HPCTypes.hpp"
+
+namespace {
+
+    /// writeFixed で扱える精度の最大値
+    const int PrecisionMax = 6;
+
+    /// 10 の累乗
+    const int PowerOf10[PrecisionMax + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+    //------------------------------------------------------------------------------
+    /// 0 以上の整数を 10 進数の文字列にします。
+    ///
+    /// @param[in]  aValue  変換する値。
+    /// @param[in]  aDigits 最低限出力する桁数。足りない桁は 0 で埋めます。
+    /// @param[out] aStr    出力先。終端文字は付けません。
+    ///
+    /// @return 出力した文字数。
+    int FormatUnsigned(uint aValue, int aDigits, char* aStr)
+    {
+        char digits[16];
+        int count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + aValue % 10);
+            aValue /= 10;
+        } while (aValue != 0 || count < aDigits);
+        for (int index = 0; index < count; ++index) {
+            aStr[index] = digits[count - 1 - index];
+        }
+        return count;
+    }
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 出力先を指定してインスタンスを生成します。
+    ///
+    /// @param[in] aFile         出力先。
+    /// @param[in] aIsCompressed 圧縮した形で出力するか。
+    ///                          @c true の場合、 writeDebug で指定した改行やインデントは出力されません。
+    JsonWriter::JsonWriter(std::FILE* aFile, bool aIsCompressed)
+        : mFile(aFile)
+        , mIsCompressed(aIsCompressed)
+        , mBuffer()
+        , mSize(0)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 出力されていない文字列を出力してからインスタンスを破棄します。
+    JsonWriter::~JsonWriter()
+    {
+        flush();
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aStr 出力する文字列。
+    void JsonWriter::write(const char* aStr)
+    {
+        put(aStr, static_cast<int>(std::strlen(aStr)));
+    }
+
+    //------------------------------------------------------------------------------
+    /// 改行やインデントなど、整形のための文字列を出力します。
+    /// 圧縮した形で出力する場合は何もしません。
+    ///
+    /// @param[in] aStr 出力する文字列。
+    void JsonWriter::writeDebug(const char* aStr)
+    {
+        if (!mIsCompressed) {
+            write(aStr);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// std::printf の "%d" と同じ形式で整数を出力します。
+    ///
+    /// @param[in] aValue 出力する値。
+    void JsonWriter::writeInt(int aValue)
+    {
+        char str[NumberLengthMax];
+        int length = 0;
+        uint absValue = static_cast<uint>(aValue);
+        if (aValue < 0) {
+            str[length++] = '-';
+            absValue = 0u - absValue;
+        }
+        length += FormatUnsigned(absValue, 1, str + length);
+        put(str, length);
+    }
+
+    //------------------------------------------------------------------------------
+    /// std::printf の "%*.*f" と同じ形式で浮動小数を出力します。
+    ///
+    /// float の値を 10 の aPrecision 乗倍した値は double で誤差なく表せるため、
+    /// その値を最近接偶数に丸めることで std::printf と同じ結果になります。
+    /// 整数部が大きすぎる値や、無限大・非数の場合は std::sprintf で変換します。
+    ///
+    /// @param[in] aValue     出力する値。
+    /// @param[in] aWidth     最小の幅。足りない場合は左側を空白で埋めます。
+    /// @param[in] aPrecision 小数点以下の桁数。 [1, 6] の範囲で指定します。
+    void JsonWriter::writeFixed(float aValue, int aWidth, int aPrecision)
+    {
+        HPC_RANGE_ASSERT_MIN_MAX_I(aPrecision, 1, PrecisionMax);
+        HPC_RANGE_ASSERT_MIN_UB_I(aWidth, 0, NumberLengthMax);
+
+        char str[NumberLengthMax];
+        const double scaled = std::fabs(static_cast<double>(aValue)) * PowerOf10[aPrecision];
+        if (!(scaled < 4294967295.0)) {
+            const int length = std::sprintf(str, "%*.*f", aWidth, aPrecision, aValue);
+            put(str, length);
+            return;
+        }
+
+        // 最近接偶数に丸める
+        const double floored = std::floor(scaled);
+        const double fraction = scaled - floored;
+        uint rounded = static_cast<uint>(floored);
+        if (0.5 < fraction || (fraction == 0.5 && (rounded & 1))) {
+            ++rounded;
+        }
+
+        // 符号は -0.0 の場合も出力する
+        uint bits = 0;
+        std::memcpy(&bits, &aValue, sizeof(bits));
+        const bool isNegative = (bits >> 31) != 0;
+
+        char body[NumberLengthMax];
+        int bodyLength = 0;
+        if (isNegative) {
+            body[bodyLength++] = '-';
+        }
+        bodyLength += FormatUnsigned(rounded / PowerOf10[aPrecision], 1, body + bodyLength);
+        body[bodyLength++] = '.';
+        bodyLength += FormatUnsigned(rounded % PowerOf10[aPrecision], aPrecision, body + bodyLength);
+
+        int length = 0;
+        for (; length + bodyLength < aWidth; ++length) {
+            str[length] = ' ';
+        }
+        std::memcpy(str + length, body, bodyLength);
+        put(str, length + bodyLength);
+    }
+
+    //------------------------------------------------------------------------------
+    /// バッファに溜めた文字列を 1 回の std::fwrite で出力します。
+    void JsonWriter::flush()
+    {
+        if (0 < mSize) {
+            std::fwrite(mBuffer, 1, mSize, mFile);
+            mSize = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 圧縮した形で出力する場合は @c true を返します。
+    bool JsonWriter::isCompressed()const
+    {
+        return mIsCompressed;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 文字列をバッファに追加します。
+    void JsonWriter::put(const char* aStr, int aLength)
+    {
+        if (BufferSize < mSize + aLength) {
+            flush();
+        }
+        if (BufferSize < aLength) {
+            std::fwrite(aStr, 1, aLength, mFile);
+            return;
+        }
+        std::memcpy(mBuffer + mSize, aStr, aLength);
+        mSize += aLength;
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    JsonWriter クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// JSON の出力を行います。
+    ///
+    /// 出力する文字列はバッファに溜め、バッファが一杯になるか flush を呼んだときに
+    /// 1 回の std::fwrite でまとめて出力します。
+    /// 数値は std::printf の "%d" や "%7.3f" と同じ文字列になるように変換します。
+    class JsonWriter
+    {
+    public:
+        JsonWriter(std::FILE* aFile, bool aIsCompressed);
+        ~JsonWriter();
+
+        /// @name 出力
+        //@{
+        void write(const char* aStr);                   ///< 文字列を出力します。
+        void writeDebug(const char* aStr);              ///< 整形して出力する場合のみ文字列を出力します。
+        void writeInt(int aValue);                      ///< 整数を出力します。
+        /// 浮動小数を固定小数点形式で出力します。
+        void writeFixed(float aValue, int aWidth, int aPrecision);
+        //@}
+
+        void flush();                                   ///< バッファの内容を出力します。
+        bool isCompressed()const;                       ///< 圧縮した形で出力するかを返します。
+
+    private:
+        static const int BufferSize = 256 * 1024;       ///< バッファのバイト数
+        static const int NumberLengthMax = 64;          ///< 1 つの数値を表す文字列の最大長
+
+        std::FILE* mFile;                               ///< 出力先
+        bool mIsCompressed;                             ///< 圧縮した形で出力するか
+        char mBuffer[BufferSize];                       ///< 出力待ちの文字列
+        int mSize;                                      ///< 出力待ちの文字数
+
+        void put(const char* aStr, int aLength);
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
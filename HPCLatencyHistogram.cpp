@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCLatencyHistogram.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCLatencyHistogram.hpp"
+
+#include <cmath>
+#include "HPCCommon.hpp"
+#include "HPCMath.hpp"
+
+namespace {
+    using namespace hpc;
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aSec 時間 (秒)。
+    ///
+    /// @return aSec が含まれる階級の番号。範囲外の値は両端の階級になります。
+    int ToBucket(double aSec)
+    {
+        if (!(0.0 < aSec)) {
+            return 0;
+        }
+        // aSec = fraction * 2^exponent, fraction は [0.5, 1)
+        int exponent = 0;
+        const double fraction = std::frexp(aSec, &exponent);
+        const int sub = static_cast<int>((fraction - 0.5) * 2.0 * LatencyHistogram::SubBucketCount);
+        const int bucket = (exponent - 1 - LatencyHistogram::MinExponent) * LatencyHistogram::SubBucketCount + sub;
+        return Math::LimitMinMax(bucket, 0, LatencyHistogram::BucketCount - 1);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aBucket 階級の番号。
+    ///
+    /// @return aBucket の階級に含まれる時間の上限 (秒)。
+    double BucketUpperSec(int aBucket)
+    {
+        const int exponent = aBucket / LatencyHistogram::SubBucketCount + LatencyHistogram::MinExponent;
+        const int sub = aBucket % LatencyHistogram::SubBucketCount;
+        return std::ldexp(1.0 + static_cast<double>(sub + 1) / LatencyHistogram::SubBucketCount, exponent);
+    }
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 記録が空の状態でインスタンスを生成します。
+    LatencyHistogram::LatencyHistogram()
+        : mBuckets()
+        , mCount(0)
+        , mSum(0)
+        , mMax(0)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 記録をすべて破棄し、生成直後の状態に戻します。
+    void LatencyHistogram::reset()
+    {
+        *this = LatencyHistogram();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 時間を1つ記録します。
+    ///
+    /// @param[in] aSec 記録する時間 (秒)。
+    void LatencyHistogram::add(double aSec)
+    {
+        ++mBuckets[ToBucket(aSec)];
+        ++mCount;
+        mSum += aSec;
+        if (mMax < aSec) {
+            mMax = aSec;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 他の LatencyHistogram の記録を、この記録に合わせます。
+    ///
+    /// @param[in] aOther 合わせる記録。
+    void LatencyHistogram::merge(const LatencyHistogram& aOther)
+    {
+        for (int index = 0; index < BucketCount; ++index) {
+            mBuckets[index] += aOther.mBuckets[index];
+        }
+        mCount += aOther.mCount;
+        mSum += aOther.mSum;
+        if (mMax < aOther.mMax) {
+            mMax = aOther.mMax;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 記録した数。
+    int LatencyHistogram::count()const
+    {
+        return mCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 記録した時間の平均 (秒)。記録が無い場合は 0 です。
+    double LatencyHistogram::mean()const
+    {
+        return 0 < mCount ? mSum / mCount : 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 記録した時間の最大値 (秒)。記録が無い場合は 0 です。
+    double LatencyHistogram::max()const
+    {
+        return mMax;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 記録した時間を小さい順に並べたとき、下から aRate の割合の位置にある値を求めます。
+    ///
+    /// 値はその位置を含む階級の上限で近似しますが、最大値を超えることはありません。
+    ///
+    /// @param[in] aRate 割合。 [0, 1] の範囲で指定します。 0.99 なら 99 パーセンタイルです。
+    ///
+    /// @return 時間 (秒)。記録が無い場合は 0 です。
+    double LatencyHistogram::percentile(double aRate)const
+    {
+        HPC_ASSERT(0.0 <= aRate && aRate <= 1.0);
+        if (mCount == 0) {
+            return 0;
+        }
+        
+        // 何番目の値か (1 始まり)
+        const int rank = Math::Max(static_cast<int>(std::ceil(aRate * mCount)), 1);
+        int accum = 0;
+        for (int index = 0; index < BucketCount; ++index) {
+            accum += mBuckets[index];
+            if (rank <= accum) {
+                const double upperSec = BucketUpperSec(index);
+                return upperSec < mMax ? upperSec : mMax;
+            }
+        }
+        return mMax;
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
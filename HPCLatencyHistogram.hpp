@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    LatencyHistogram クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 処理時間の分布を、対数で区切った階級の度数として記録します。
+    ///
+    /// 2倍ごとの区間を SubBucketCount 個に等分した階級を使うので、
+    /// percentile が返す値の誤差は 1 / SubBucketCount (12.5%) 以内です。
+    /// 標本そのものは保持しないため、標本数によらず一定のメモリで記録できます。
+    /// ポインタを含まないので、そのままコピーして受け渡すことができます。
+    class LatencyHistogram
+    {
+    public:
+        static const int SubBucketCount = 8;                ///< 2倍ごとの区間の分割数
+        static const int MinExponent = -30;                 ///< 記録する最小の時間 2^MinExponent 秒 (約 1 ナノ秒)
+        static const int MaxExponent = 7;                   ///< 記録する最大の時間 2^MaxExponent 秒 (128 秒)
+        static const int BucketCount = (MaxExponent - MinExponent) * SubBucketCount; ///< 階級の数
+
+        LatencyHistogram();
+
+        void reset();                                       ///< 記録をすべて破棄します。
+        void add(double aSec);                              ///< 時間を1つ記録します。
+        void merge(const LatencyHistogram& aOther);         ///< 他の記録を合わせます。
+
+        /// @name 統計量の取得
+        //@{
+        int count()const;                                   ///< 記録した数を返します。
+        double mean()const;                                 ///< 平均を返します。
+        double max()const;                                  ///< 最大値を返します。
+        double percentile(double aRate)const;               ///< 下から aRate の位置にある値を返します。
+        //@}
+
+    private:
+        int mBuckets[BucketCount];  ///< 各階級の度数
+        int mCount;                 ///< 記録した数
+        double mSum;                ///< 記録した時間の合計
+        double mMax;                ///< 記録した時間の最大値
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -344,6 +344,25 @@ namespace hpc {
             }
         }
     }
+
+    //------------------------------------------------------------------------------
+    /// ステージを生成せずに、ステージの規模の目安を求めます。
+    ///
+    /// 1周の距離は蓮の数とフィールドの大きさにおおよそ比例するので、
+    /// (蓮の数) × (グリッドの幅 + 高さ) × (周回数) を規模とします。
+    /// ゴールまでのターン数の見積もりに使用します。
+    ///
+    /// @param[in] aNumber ステージ番号
+    ///
+    /// @return ステージの規模を表す正の値
+    float LevelDesigner::StageScale(int aNumber)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aNumber, 0, Parameter::GameStageCount);
+        const IntVec2 gridSize = GetStageGridSize(aNumber);
+        return static_cast<float>(
+            GetRandomLotusCount(aNumber) * (gridSize.x + gridSize.y) * Parameter::StageRoundCount
+            );
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -22,6 +22,8 @@ namespace hpc {
     public:
         /// ステージのマップを生成します。
         static void Setup(int aNumber, Stage& aStage, Random& aRandom);
+        /// ステージの規模の目安を返します。
+        static float StageScale(int aNumber);
 
     private:
         LevelDesigner();
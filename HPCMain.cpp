@@ -9,9 +9,17 @@
 
 //------------------------------------------------------------------------------
 
+#include <cstdlib>
 #include <cstring>
+#include "HPCBatch.hpp"
 #include "HPCCommon.hpp"
+#include "HPCRecordSink.hpp"
+#include "HPCScoreCompare.hpp"
 #include "HPCSimulation.hpp"
+#include "HPCStrategy.hpp"
+#include "HPCStrategyRegistry.hpp"
+#include "HPCThroughput.hpp"
+#include "HPCTournament.hpp"
 
 //------------------------------------------------------------------------------
 namespace {
@@ -21,18 +29,35 @@ namespace {
         Operation_NoDebug,                  ///< デバッグなし
         Operation_OutputJson,               ///< JSON の出力
         Operation_OutputJsonCompressed,     ///< 圧縮された JSON の出力
+        Operation_Batch,                    ///< 複数シードでの実行と集計
+        Operation_OutputReplay,             ///< リプレイファイルの出力
+        Operation_ReplayToJson,             ///< リプレイファイルを JSON に変換
+        Operation_ReplayToJsonCompressed,   ///< リプレイファイルを圧縮された JSON に変換
+        Operation_Stream,                   ///< 記録を送り先へ逐次出力
+        Operation_Throughput,               ///< ゲーム全体の処理速度の計測
+        Operation_CompareScores,            ///< 得点ファイルの比較
+        Operation_Tournament,               ///< 複数の戦略の比較
 
         Operation_TERM
     };
     // new, delete を使うことは出来ないので static な変数として
     // Simulation クラスを用意します。
+    // ゲームの状態は Answer の状態も含めてすべて Simulation が持つので、
+    // -T で同時に実行するゲームは、スレッドごとに別の Simulation を使います。
     hpc::Simulation sSim;
+    hpc::Batch sBatch;
+    hpc::RecordSink sSink;
+    hpc::Throughput sThroughput;
+    hpc::ScoreCompare sCompare;
+    hpc::Tournament sTournament;
 }
 
 //------------------------------------------------------------------------------
 /// アプリケーションのエントリポイントです。
 ///
 /// @return プログラムが正常に終了したら 0 を返します。
+///         -c で得点が有意に下がっていた場合は 1 を返します。
+///         引数が正しくない場合や、実行・比較・ファイルの読み書きに失敗した場合は 2 を返します。
 ///
 /// @note 起動時引数を設定することで、挙動を変更することができます。
 ///
@@ -40,35 +65,265 @@ namespace {
 ///  ------------|----------------------------------------------
 ///   -n         | デバッグを行いません。
 ///   -j         | デバッグを行わず、結果を JSON で出力します。
+///   -jd        | デバッグを行わず、結果を整形された JSON で出力します。
+///   -w [N]     | N 個のワーカーでステージを並列に実行します。
+///              | N を省略するか 0 を指定すると、コア数だけ起動します。
+///   -s A[-B]   | ステージ A から B までのみを実行します。B を省略するとステージ A のみです。
+///   -d         | 回答に各ターンの締め切りを使わせます。回答は締め切りまで探索を深めるので、
+///              | 結果は実行環境や並列数によって変わります。
+///   -p         | Answer::GetNextAction の1回ごとの応答時間を記録し、
+///              | 10 ステージごとのパーセンタイルを結果と一緒に表示します。
+///   -b SEEDS   | SEEDS に含まれる各シードでゲームを実行し、得点の統計を出力します。
+///              | SEEDS は "0-999" や "3,10-19" のように指定します。
+///              | -w を指定しない場合は、コア数だけワーカーを起動します。
+///   -S FILE    | -b と併用し、各シードのステージごとの得点を FILE に書き出します。
+///   -T         | -b と併用し、ワーカーを子プロセスの代わりに同じプロセスのスレッドとして
+///              | 実行します。処理時間の集計は表示されません。
+///   -c BASE CAND | ゲームを実行せず、 -S で書き出した2つの得点ファイルを比較します。
+///              | 同じシードの得点の差から、 CAND の得点が BASE より有意に下がった
+///              | ステージと合計得点を表示します。
+///   -r FILE    | デバッグを行わず、結果をバイナリ形式のリプレイファイル FILE に出力します。
+///   -rj FILE   | ゲームを実行せず、リプレイファイル FILE を JSON に変換して出力します。
+///   -rjd FILE  | ゲームを実行せず、リプレイファイル FILE を整形された JSON に変換して出力します。
+///   -o SINK    | デバッグを行わず、各ターンの記録をメモリに残さずに SINK へ逐次送ります。
+///              | SINK は次のいずれかです。 null 以外は -w と併用できません。
+///              |   null         記録を捨てます。
+///              |   ring         各ステージの直近のターンのみを保持し、最後に表示します。
+///              |   file:PATH    PATH にリプレイ形式で書き出します。
+///              |   pipe:COMMAND COMMAND を起動し、その標準入力へリプレイ形式で書き出します。
+///   -t [K]     | 制限時間で打ち切らずにゲームを K 回続けて実行し、1秒あたりのターン数などを
+///              | JSON で出力します。記録なし、記録あり、記録と JSON 出力ありの各条件で
+///              | 計測します。 K を省略した場合は 1 回です。 -w は無視されます。
+///   -a NAMES   | プレイヤーの戦略を選びます。既定値は Answer.cpp を使う answer です。
+///              | 1つだけ指定した場合は、他のオプションと組み合わせて使えます。
+///              | "answer,cpu" のように複数指定すると、デバッグを行わず、各戦略で
+///              | 同じステージを実行してステージごとの得点を並べて表示します。
+///              | list を指定すると、組み込まれている戦略の一覧を表示します。
 ///
 int main(int argc, const char* argv[])
 {
     Operation operation = Operation_Normal;
-    
-    // 引数は 1 つまで有効。
-    if (argc > 2) {
-        HPC_PRINT("Invalid Argument.\n");
-        return 0;
-    }
+    int workerCount = 1;
+    bool hasWorkerCount = false;
+    bool hasOperation = false;
+    const char* replayPath = 0;
+    const char* scorePaths[2] = {};
+
     // 引数がある場合、引数を記録する。
-    else if (argc > 1) {
-        if (!std::strcmp(argv[1], "-n")) {
+    for (int index = 1; index < argc; ++index) {
+        const char* arg = argv[index];
+        if (!std::strcmp(arg, "-w")) {
+            // ワーカー数は省略できる。
+            workerCount = 0;
+            hasWorkerCount = true;
+            if (index + 1 < argc && '0' <= argv[index + 1][0] && argv[index + 1][0] <= '9') {
+                workerCount = std::atoi(argv[++index]);
+            }
+            continue;
+        }
+        if (!std::strcmp(arg, "-S")) {
+            if (index + 1 >= argc) {
+                HPC_PRINT("Invalid Argument: -S requires a file name.\n");
+                return 2;
+            }
+            sBatch.setScorePath(argv[++index]);
+            continue;
+        }
+        if (!std::strcmp(arg, "-a")) {
+            if (index + 1 >= argc || !sTournament.setupEntries(argv[index + 1])) {
+                const bool isListRequested = index + 1 < argc && !std::strcmp(argv[index + 1], "list");
+                if (index + 1 < argc && !isListRequested) {
+                    HPC_PRINT("Invalid Argument: %s is unknown strategy.\n", argv[index + 1]);
+                }
+                HPC_PRINT("Strategies:\n");
+                hpc::StrategyRegistry::PrintList();
+                return isListRequested ? 0 : 2;
+            }
+            ++index;
+            continue;
+        }
+        if (!std::strcmp(arg, "-T")) {
+            sBatch.setThreaded(true);
+            continue;
+        }
+        if (!std::strcmp(arg, "-d")) {
+            sSim.setDeadlineEnabled(true);
+            continue;
+        }
+        if (!std::strcmp(arg, "-p")) {
+            sSim.setLatencyEnabled(true);
+            continue;
+        }
+        if (!std::strcmp(arg, "-s")) {
+            if (index + 1 >= argc) {
+                HPC_PRINT("Invalid Argument: -s requires a stage number.\n");
+                return 2;
+            }
+            const char* rangeStr = argv[++index];
+            const char* lastStr = std::strchr(rangeStr, '-');
+            const int first = std::atoi(rangeStr);
+            const int last = lastStr ? std::atoi(lastStr + 1) : first;
+            if (first < 0 || last < first || hpc::Parameter::GameStageCount <= last) {
+                HPC_PRINT("Invalid Argument: %s is invalid stage range.\n", rangeStr);
+                return 2;
+            }
+            sSim.setStageRange(first, last + 1);
+            continue;
+        }
+
+        // 動作を指定する引数は 1 つまで有効。
+        if (hasOperation) {
+            HPC_PRINT("Invalid Argument.\n");
+            return 2;
+        }
+        hasOperation = true;
+
+        if (!std::strcmp(arg, "-n")) {
             operation = Operation_NoDebug;
         }
-        else if (!std::strcmp(argv[1], "-j")) {
+        else if (!std::strcmp(arg, "-j")) {
             operation = Operation_OutputJsonCompressed;
         }
-        else if (!std::strcmp(argv[1], "-jd")) {
+        else if (!std::strcmp(arg, "-jd")) {
             operation = Operation_OutputJson;
         }
+        else if (!std::strcmp(arg, "-b")) {
+            if (index + 1 >= argc || !sBatch.setupSeeds(argv[index + 1])) {
+                HPC_PRINT("Invalid Argument: -b requires a valid seed list.\n");
+                return 2;
+            }
+            ++index;
+            operation = Operation_Batch;
+            if (!hasWorkerCount) {
+                workerCount = 0;
+            }
+        }
+        else if (!std::strcmp(arg, "-c")) {
+            if (index + 2 >= argc) {
+                HPC_PRINT("Invalid Argument: -c requires two score files.\n");
+                return 2;
+            }
+            scorePaths[0] = argv[++index];
+            scorePaths[1] = argv[++index];
+            operation = Operation_CompareScores;
+        }
+        else if (!std::strcmp(arg, "-t")) {
+            // 実行回数は省略できる。
+            if (index + 1 < argc && '0' <= argv[index + 1][0] && argv[index + 1][0] <= '9') {
+                const int runCount = std::atoi(argv[++index]);
+                if (runCount < 1 || hpc::Throughput::RunCountMax < runCount) {
+                    HPC_PRINT("Invalid Argument: -t must be in [1, %d].\n", hpc::Throughput::RunCountMax);
+                    return 2;
+                }
+                sThroughput.setRunCount(runCount);
+            }
+            operation = Operation_Throughput;
+        }
+        else if (!std::strcmp(arg, "-r") || !std::strcmp(arg, "-rj") || !std::strcmp(arg, "-rjd")) {
+            if (index + 1 >= argc) {
+                HPC_PRINT("Invalid Argument: %s requires a file name.\n", arg);
+                return 2;
+            }
+            replayPath = argv[++index];
+            if (!std::strcmp(arg, "-r")) {
+                operation = Operation_OutputReplay;
+            }
+            else if (!std::strcmp(arg, "-rj")) {
+                operation = Operation_ReplayToJsonCompressed;
+            }
+            else {
+                operation = Operation_ReplayToJson;
+            }
+        }
+        else if (!std::strcmp(arg, "-o")) {
+            if (index + 1 >= argc) {
+                HPC_PRINT("Invalid Argument: -o requires a sink.\n");
+                return 2;
+            }
+            const char* sinkStr = argv[++index];
+            bool isOpened = true;
+            if (!std::strcmp(sinkStr, "null")) {
+                sSink.setupNull();
+            }
+            else if (!std::strcmp(sinkStr, "ring")) {
+                sSink.setupRingBuffer();
+            }
+            else if (!std::strncmp(sinkStr, "file:", 5)) {
+                isOpened = sSink.openFile(sinkStr + 5);
+            }
+            else if (!std::strncmp(sinkStr, "pipe:", 5)) {
+                isOpened = sSink.openPipe(sinkStr + 5);
+            }
+            else {
+                HPC_PRINT("Invalid Argument: %s is unknown sink.\n", sinkStr);
+                return 2;
+            }
+            if (!isOpened) {
+                HPC_PRINT("Failed to open %s.\n", sinkStr);
+                return 2;
+            }
+            operation = Operation_Stream;
+        }
         else {
-            HPC_PRINT("Invalid Argument: %s is unknown command.\n", argv[1]);
-            return 0;
+            HPC_PRINT("Invalid Argument: %s is unknown command.\n", arg);
+            return 2;
+        }
+    }
+    if (1 < sTournament.entryCount()) {
+        if (hasOperation) {
+            HPC_PRINT("Invalid Argument: -a with several strategies cannot be used with other commands.\n");
+            return 2;
         }
+        operation = Operation_Tournament;
     }
+    else if (sTournament.entryCount() == 1 && !sSim.setPlayerStrategy(sTournament.entry(0))) {
+        HPC_PRINT("Failed to set up %s.\n", sTournament.entry(0).name);
+        return 2;
+    }
+    if (operation == Operation_Stream && sSink.type() != hpc::RecordSinkType_Null && workerCount != 1) {
+        HPC_PRINT("Invalid Argument: -o cannot be used with -w except for null sink.\n");
+        return 2;
+    }
+
     // プログラムの実行
-    {
-        sSim.run();
+    if (operation == Operation_Tournament) {
+        sTournament.run(sSim, workerCount);
+        sTournament.outputResult();
+    }
+    else if (operation == Operation_Batch) {
+        const bool isSucceeded = sBatch.run(sSim, workerCount);
+        sBatch.outputResult();
+        if (!isSucceeded) {
+            return 2;
+        }
+    }
+    else if (operation == Operation_CompareScores) {
+        if (!sCompare.run(scorePaths[0], scorePaths[1])) {
+            return 2;
+        }
+        sCompare.outputResult();
+        return sCompare.hasRegression() ? 1 : 0;
+    }
+    else if (operation == Operation_Throughput) {
+        // -a で指定しない場合は、回答の探索の時間を含めないように処理量が一定の戦略で計測する
+        if (sTournament.entryCount() == 0 && !sSim.setPlayerStrategy(hpc::Throughput::DefaultStrategy())) {
+            HPC_PRINT("Failed to set up %s.\n", hpc::Throughput::DefaultStrategy().name);
+            return 2;
+        }
+        sThroughput.run(sSim);
+        sThroughput.outputResult();
+    }
+    else if (operation == Operation_ReplayToJson || operation == Operation_ReplayToJsonCompressed) {
+        if (!sSim.loadReplay(replayPath)) {
+            return 2;
+        }
+        sSim.outputJson(operation == Operation_ReplayToJsonCompressed);
+    }
+    else {
+        if (operation == Operation_Stream) {
+            sSim.setRecordSink(&sSink);
+        }
+        sSim.run(workerCount);
 
         switch (operation) {
         case Operation_Normal:
@@ -88,6 +343,22 @@ int main(int argc, const char* argv[])
             sSim.outputJson(true);
             break;
 
+        case Operation_OutputReplay:
+            sSim.outputResult();
+            if (!sSim.outputReplay(replayPath)) {
+                return 2;
+            }
+            break;
+
+        case Operation_Stream:
+            sSim.outputResult();
+            sSink.dumpRing();
+            if (!sSink.close()) {
+                HPC_PRINT("Failed to write the record.\n");
+                return 2;
+            }
+            break;
+
         default:
             HPC_SHOULD_NOT_REACH_HERE();
             break;
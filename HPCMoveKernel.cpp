@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCMoveKernel.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCMoveKernel.hpp"
+
+#include "HPCCommon.hpp"
+#include "HPCMath.hpp"
+#include "HPCParameter.hpp"
+#include "HPCVec2.hpp"
+
+#if defined(__AVX__)
+    #define HPC_MOVE_KERNEL_AVX
+    #include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP)
+    #define HPC_MOVE_KERNEL_SSE
+    #include <emmintrin.h>
+#endif
+
+namespace {
+    using namespace hpc;
+
+    //------------------------------------------------------------------------------
+    /// 1キャラ分の移動と減速を行います。
+    void MoveOne(Vec2& aPos, Vec2& aVel, const Vec2& aFlowVel)
+    {
+        // 速度分移動 ＆ フィールドの流れる速度を反映
+        aPos += aVel + aFlowVel;
+        
+        // 減速させる
+        if (!aVel.isZero()) {
+            const float len = Math::Max(
+                aVel.length() - Parameter::CharaDecelSpeed()
+                , 0.0f
+                );
+            if (0.0f < len) {
+                aVel.normalize(len);
+            } else {
+                aVel.reset();
+            }
+        }
+    }
+
+#if defined(HPC_MOVE_KERNEL_SSE)
+    //------------------------------------------------------------------------------
+    /// 2キャラ分の (x0, y0, x1, y1) をまとめて移動、減速させます。
+    ///
+    /// 長さは x * x + y * y の順に足してから平方根を取り、
+    /// 正規化は長さで割ってから目標の長さを掛けるので、 MoveOne と同じ結果になります。
+    /// ゼロベクトルの要素は 0 / 0 を計算しますが、最後にマスクで 0 に置き換えます。
+    inline void MoveSse(float* aPos, float* aVel, __m128 aFlow, __m128 aDecel)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 vel = _mm_loadu_ps(aVel);
+        _mm_storeu_ps(aPos, _mm_add_ps(_mm_loadu_ps(aPos), _mm_add_ps(vel, aFlow)));
+        
+        const __m128 sq = _mm_mul_ps(vel, vel);
+        const __m128 squareLength = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        const __m128 length = _mm_sqrt_ps(squareLength);
+        const __m128 len = _mm_max_ps(_mm_sub_ps(length, aDecel), zero);
+        const __m128 normalized = _mm_mul_ps(_mm_div_ps(vel, length), len);
+        _mm_storeu_ps(aVel, _mm_and_ps(_mm_cmplt_ps(zero, len), normalized));
+    }
+#endif
+
+#if defined(HPC_MOVE_KERNEL_AVX)
+    //------------------------------------------------------------------------------
+    /// 4キャラ分をまとめて移動、減速させます。計算の内容は SSE 版と同じです。
+    inline void MoveAvx(float* aPos, float* aVel, __m256 aFlow, __m256 aDecel)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 vel = _mm256_loadu_ps(aVel);
+        _mm256_storeu_ps(aPos, _mm256_add_ps(_mm256_loadu_ps(aPos), _mm256_add_ps(vel, aFlow)));
+        
+        const __m256 sq = _mm256_mul_ps(vel, vel);
+        const __m256 squareLength = _mm256_add_ps(sq, _mm256_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        const __m256 length = _mm256_sqrt_ps(squareLength);
+        const __m256 len = _mm256_max_ps(_mm256_sub_ps(length, aDecel), zero);
+        const __m256 normalized = _mm256_mul_ps(_mm256_div_ps(vel, length), len);
+        _mm256_storeu_ps(aVel, _mm256_and_ps(_mm256_cmp_ps(zero, len, _CMP_LT_OQ), normalized));
+    }
+#endif
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// aCount 体のキャラを、それぞれの速度とフィールドの流れの分だけ移動させ、
+    /// 速さを Parameter::CharaDecelSpeed() だけ減らします。
+    ///
+    /// @param[in,out] aPos     各キャラの位置。 aCount 個の要素が必要です。
+    /// @param[in,out] aVel     各キャラの速度。 aCount 個の要素が必要です。
+    /// @param[in]     aCount   キャラ数。
+    /// @param[in]     aFlowVel フィールドの流れる速度。
+    void MoveKernel::Move(
+        Vec2* aPos
+        , Vec2* aVel
+        , int aCount
+        , const Vec2& aFlowVel
+        )
+    {
+        HPC_ASSERT(0 <= aCount);
+        int index = 0;
+        
+#if defined(HPC_MOVE_KERNEL_AVX)
+        {
+            const __m256 flow = _mm256_setr_ps(
+                aFlowVel.x, aFlowVel.y, aFlowVel.x, aFlowVel.y
+                , aFlowVel.x, aFlowVel.y, aFlowVel.x, aFlowVel.y
+                );
+            const __m256 decel = _mm256_set1_ps(Parameter::CharaDecelSpeed());
+            for (; index + 4 <= aCount; index += 4) {
+                MoveAvx(&aPos[index].x, &aVel[index].x, flow, decel);
+            }
+        }
+#endif
+#if defined(HPC_MOVE_KERNEL_SSE)
+        {
+            const __m128 flow = _mm_setr_ps(aFlowVel.x, aFlowVel.y, aFlowVel.x, aFlowVel.y);
+            const __m128 decel = _mm_set1_ps(Parameter::CharaDecelSpeed());
+            for (; index + 2 <= aCount; index += 2) {
+                MoveSse(&aPos[index].x, &aVel[index].x, flow, decel);
+            }
+        }
+#endif
+        
+        // 残りは1キャラずつ計算する
+        for (; index < aCount; ++index) {
+            MoveOne(aPos[index], aVel[index], aFlowVel);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 使用している命令セットの名前。
+    const char* MoveKernel::InstructionSetName()
+    {
+#if defined(HPC_MOVE_KERNEL_AVX)
+        return "AVX";
+#elif defined(HPC_MOVE_KERNEL_SSE)
+        return "SSE2";
+#else
+        return "Scalar";
+#endif
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
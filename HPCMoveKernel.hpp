@@ -0,0 +1,41 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    MoveKernel クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    class Vec2;
+
+    //------------------------------------------------------------------------------
+    /// 複数のキャラの移動と減速をまとめて計算する機能を提供します。
+    ///
+    /// 先読みで多数のキャラの状態を進めるためのもので、 SSE や AVX が使える環境では
+    /// 複数のキャラを同時に計算します。使えない環境では1キャラずつ計算します。
+    /// どちらの場合も、計算の順番と丸めは CharaHotBlock::move と同じなので、
+    /// 結果はビット単位で一致します。
+    class MoveKernel
+    {
+    public:
+        /// aCount 体のキャラを1ターン分移動させ、減速させます。
+        static void Move(
+            Vec2* aPos
+            , Vec2* aVel
+            , int aCount
+            , const Vec2& aFlowVel
+            );
+        static const char* InstructionSetName();            ///< 使用している命令セットの名前を返します。
+
+    private:
+        MoveKernel();
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
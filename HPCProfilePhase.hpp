@@ -0,0 +1,31 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    ProfilePhase 列挙型
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// @brief Profiler で時間を計測する処理の区分を定義します。
+    enum ProfilePhase {
+        ProfilePhase_AnswerInit,            ///< Answer::Init
+        ProfilePhase_AnswerGetNextAction,   ///< Answer::GetNextAction
+        ProfilePhase_CpuBrain,              ///< CPU の動作決定
+        ProfilePhase_ExecAction,            ///< CharaCollection::procExecAction
+        ProfilePhase_CheckColl,             ///< CharaCollection::procCheckColl
+        ProfilePhase_End,                   ///< CharaCollection::procEnd (順位の更新を除く)
+        ProfilePhase_UpdateRank,            ///< CharaCollection::updateRank
+        ProfilePhase_RecordWriteTurn,       ///< Record::writeTurn
+
+        ProfilePhase_TERM
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
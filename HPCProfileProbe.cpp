@@ -0,0 +1,39 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCProfileProbe.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCProfileProbe.hpp"
+
+#include "HPCProfiler.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aProfiler 加算先の Profiler 。 0 の場合は計測しません。
+    /// @param[in] aPhase    計測する処理の区分。
+    ProfileProbe::ProfileProbe(Profiler* aProfiler, ProfilePhase aPhase)
+        : mProfiler(aProfiler)
+        , mPhase(aPhase)
+        , mBeginSec(aProfiler ? Profiler::NowSec() : 0)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 生成してからの時間を Profiler に加算します。
+    ProfileProbe::~ProfileProbe()
+    {
+        if (mProfiler) {
+            mProfiler->add(mPhase, Profiler::NowSec() - mBeginSec);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,39 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    ProfileProbe クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCProfilePhase.hpp"
+
+namespace hpc {
+    class Profiler;
+
+    //------------------------------------------------------------------------------
+    /// 生成されてから破棄されるまでの時間を計測し、 Profiler に加算します。
+    ///
+    /// 計測したい範囲をブロックで囲み、その先頭でローカル変数として生成します。
+    /// Profiler が 0 の場合は時刻を読まず、何も計測しません。
+    class ProfileProbe
+    {
+    public:
+        ProfileProbe(Profiler* aProfiler, ProfilePhase aPhase); ///< 計測を開始します。
+        ~ProfileProbe();                                    ///< 計測を終了します。
+
+    private:
+        Profiler* const mProfiler;  ///< 加算先の Profiler 。計測しなければ 0
+        const ProfilePhase mPhase;  ///< 計測する処理の区分
+        const double mBeginSec;     ///< 計測を開始した時刻
+
+        ProfileProbe(const ProfileProbe&);
+        ProfileProbe& operator=(const ProfileProbe&);
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCProfiler.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCProfiler.hpp"
+
+#include <cstdio>
+#include <ctime>
+#include "HPCCommon.hpp"
+#include "HPCMath.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define HPC_PROFILER_CLOCK_GETTIME
+    #include <time.h>
+#elif defined(_WIN32)
+    #define HPC_PROFILER_QUERY_PERFORMANCE_COUNTER
+    #include <windows.h>
+#endif
+
+namespace {
+    using namespace hpc;
+
+    /// 各処理の表示名
+    const char* const PhaseNames[ProfilePhase_TERM] = {
+        "Init",
+        "Answer",
+        "CpuBrain",
+        "ExecAction",
+        "CheckColl",
+        "End",
+        "UpdateRank",
+        "WriteTurn",
+    };
+
+    /// 応答時間の分布をまとめて表示するステージ数。
+    /// LevelDesigner はステージ番号の 10 の位ごとにステージの大きさを変えるため、それに合わせる。
+    const int LatencyStageBracket = 10;
+
+    //------------------------------------------------------------------------------
+    /// 表の1行を出力します。
+    ///
+    /// @param[in] aName     行の名前。
+    /// @param[in] aSec      時間の合計。
+    /// @param[in] aTotalSec 割合の基準となる時間。
+    /// @param[in] aCount    計測回数。0 の場合は回数と平均を表示しません。
+    /// @param[in] aMaxStage 時間が最も長いステージ番号。負の場合は表示しません。
+    /// @param[in] aMaxSec   aMaxStage の時間。
+    void PrintRow(const char* aName, double aSec, double aTotalSec, int aCount, int aMaxStage, double aMaxSec)
+    {
+        const double share = 0.0 < aTotalSec ? aSec / aTotalSec * 100.0 : 0.0;
+        HPC_PRINT("  %-11s%11.3f%7.1f%%", aName, aSec * 1000.0, share);
+        if (0 < aCount) {
+            HPC_PRINT("%10d%10.3f", aCount, aSec / aCount * 1000000.0);
+        } else {
+            HPC_PRINT("%10s%10s", "-", "-");
+        }
+        if (0 <= aMaxStage) {
+            HPC_PRINT("%7d%11.3f", aMaxStage, aMaxSec * 1000.0);
+        }
+        HPC_PRINT("\n");
+    }
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// コンストラクタです。
+    Profiler::Profiler()
+        : mIsLatencyEnabled(false)
+        , mCurrentStage(-1)
+        , mStageBeginSec(0)
+        , mStageBeginClock(0)
+    {
+        reset();
+    }
+
+    //------------------------------------------------------------------------------
+    /// すべてのステージの集計結果を破棄します。
+    void Profiler::reset()
+    {
+        for (int index = 0; index < Parameter::GameStageCount; ++index) {
+            mStages[index] = StageData();
+        }
+        mCurrentStage = -1;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの計測を開始します。以降の add は aStageIndex のステージに加算されます。
+    ///
+    /// @param[in] aStageIndex ステージ番号。
+    void Profiler::beginStage(int aStageIndex)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        mCurrentStage = aStageIndex;
+        mStageBeginSec = NowSec();
+        mStageBeginClock = std::clock();
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの計測を終了し、ステージ全体の実時間と CPU 時間を記録します。
+    void Profiler::endStage()
+    {
+        if (mCurrentStage < 0) {
+            return;
+        }
+        StageData& data = mStages[mCurrentStage];
+        data.wallSec += NowSec() - mStageBeginSec;
+        data.cpuSec += static_cast<double>(std::clock() - mStageBeginClock) / CLOCKS_PER_SEC;
+        mCurrentStage = -1;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 計測中のステージに、処理の時間を加算します。
+    /// ステージを計測していない場合は何もしません。
+    ///
+    /// @param[in] aPhase 処理の区分。
+    /// @param[in] aSec   処理に掛かった時間 (秒)。
+    void Profiler::add(ProfilePhase aPhase, double aSec)
+    {
+        if (mCurrentStage < 0) {
+            return;
+        }
+        StageData& data = mStages[mCurrentStage];
+        data.phaseSec[aPhase] += aSec;
+        ++data.phaseCount[aPhase];
+        if (mIsLatencyEnabled && aPhase == ProfilePhase_AnswerGetNextAction) {
+            data.answerLatency.add(aSec);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 単調増加する高分解能の時計で、現在時刻を取得します。
+    /// 対応する時計がない環境では std::clock を使用します。
+    ///
+    /// @return 現在時刻 (秒)。基準となる時刻は不定なので、差のみが意味を持ちます。
+    double Profiler::NowSec()
+    {
+#if defined(HPC_PROFILER_CLOCK_GETTIME)
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+#elif defined(HPC_PROFILER_QUERY_PERFORMANCE_COUNTER)
+        LARGE_INTEGER frequency;
+        LARGE_INTEGER now;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&now);
+        return static_cast<double>(now.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+        return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// Answer::GetNextAction の1回ごとの応答時間の分布を記録するかを設定します。
+    /// 既定では記録しません。
+    ///
+    /// @param[in] aIsEnabled 記録する場合は @c true 。
+    void Profiler::setLatencyEnabled(bool aIsEnabled)
+    {
+        mIsLatencyEnabled = aIsEnabled;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 応答時間の分布を記録する場合は @c true 。
+    bool Profiler::isLatencyEnabled()const
+    {
+        return mIsLatencyEnabled;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aStageIndex ステージ番号。
+    ///
+    /// @return aStageIndex のステージの集計結果。
+    const Profiler::StageData& Profiler::stage(int aStageIndex)const
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        return mStages[aStageIndex];
+    }
+
+    //------------------------------------------------------------------------------
+    /// 他のワーカーで集計したステージの結果を設定します。
+    ///
+    /// @param[in] aStageIndex ステージ番号。
+    /// @param[in] aData       集計結果。
+    void Profiler::setStage(int aStageIndex, const StageData& aData)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        mStages[aStageIndex] = aData;
+    }
+
+    //------------------------------------------------------------------------------
+    /// [aStageBegin, aStageEnd) のステージの集計結果を、処理ごとの表で出力します。
+    ///
+    /// 各行には時間の合計、ステージ全体の実時間に対する割合、計測回数、
+    /// 1回あたりの平均時間と、時間が最も長かったステージを表示します。
+    ///
+    /// @param[in] aStageBegin 最初のステージ番号。
+    /// @param[in] aStageEnd   最後のステージ番号 + 1。
+    void Profiler::print(int aStageBegin, int aStageEnd)const
+    {
+        double wallSec = 0;
+        double cpuSec = 0;
+        double phaseTotalSec = 0;
+        for (int stage = aStageBegin; stage < aStageEnd; ++stage) {
+            wallSec += mStages[stage].wallSec;
+            cpuSec += mStages[stage].cpuSec;
+        }
+        
+        HPC_PRINT("%8s:\n", "Profile");
+        HPC_PRINT("  %-11s%11s%8s%10s%10s%7s%11s\n", "Phase", "Total[ms]", "Share", "Calls", "Mean[us]", "Stage", "Max[ms]");
+        for (int phase = 0; phase < ProfilePhase_TERM; ++phase) {
+            double sec = 0;
+            int count = 0;
+            int maxStage = aStageBegin;
+            for (int stage = aStageBegin; stage < aStageEnd; ++stage) {
+                const StageData& data = mStages[stage];
+                sec += data.phaseSec[phase];
+                count += data.phaseCount[phase];
+                if (mStages[maxStage].phaseSec[phase] < data.phaseSec[phase]) {
+                    maxStage = stage;
+                }
+            }
+            phaseTotalSec += sec;
+            PrintRow(PhaseNames[phase], sec, wallSec, count, maxStage, mStages[maxStage].phaseSec[phase]);
+        }
+        PrintRow("Other", wallSec - phaseTotalSec, wallSec, 0, -1, 0);
+        PrintRow("Wall", wallSec, wallSec, 0, -1, 0);
+        PrintRow("CPU", cpuSec, wallSec, 0, -1, 0);
+    }
+
+    //------------------------------------------------------------------------------
+    /// [aStageBegin, aStageEnd) のステージの Answer::GetNextAction の応答時間を、
+    /// 10 ステージごとにまとめて出力します。
+    ///
+    /// 各行には呼び出し回数、平均、50 / 90 / 99 パーセンタイル、最大値と、
+    /// 最大値を記録したステージを表示します。
+    ///
+    /// @param[in] aStageBegin 最初のステージ番号。
+    /// @param[in] aStageEnd   最後のステージ番号 + 1。
+    void Profiler::printLatency(int aStageBegin, int aStageEnd)const
+    {
+        HPC_PRINT("%8s:\n", "Latency");
+        HPC_PRINT("  %-9s%10s%10s%10s%10s%10s%10s%7s\n", "Stages", "Calls", "Mean[us]", "p50[us]", "p90[us]", "p99[us]", "Max[us]", "Stage");
+        LatencyHistogram total;
+        int totalMaxStage = aStageBegin;
+        for (int bracketBegin = aStageBegin; bracketBegin < aStageEnd; ) {
+            const int bracketEnd = Math::Min((bracketBegin / LatencyStageBracket + 1) * LatencyStageBracket, aStageEnd);
+            LatencyHistogram bracket;
+            int maxStage = bracketBegin;
+            for (int stage = bracketBegin; stage < bracketEnd; ++stage) {
+                const LatencyHistogram& latency = mStages[stage].answerLatency;
+                bracket.merge(latency);
+                if (mStages[maxStage].answerLatency.max() < latency.max()) {
+                    maxStage = stage;
+                }
+                if (mStages[totalMaxStage].answerLatency.max() < latency.max()) {
+                    totalMaxStage = stage;
+                }
+            }
+            total.merge(bracket);
+            
+            char name[32];
+            std::sprintf(name, "%d-%d", bracketBegin, bracketEnd - 1);
+            HPC_PRINT("  %-9s%10d%10.1f%10.1f%10.1f%10.1f%10.1f%7d\n"
+                , name
+                , bracket.count()
+                , bracket.mean() * 1000000.0
+                , bracket.percentile(0.5) * 1000000.0
+                , bracket.percentile(0.9) * 1000000.0
+                , bracket.percentile(0.99) * 1000000.0
+                , bracket.max() * 1000000.0
+                , maxStage
+                );
+            bracketBegin = bracketEnd;
+        }
+        HPC_PRINT("  %-9s%10d%10.1f%10.1f%10.1f%10.1f%10.1f%7d\n"
+            , "All"
+            , total.count()
+            , total.mean() * 1000000.0
+            , total.percentile(0.5) * 1000000.0
+            , total.percentile(0.9) * 1000000.0
+            , total.percentile(0.99) * 1000000.0
+            , total.max() * 1000000.0
+            , totalMaxStage
+            );
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Profiler クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <ctime>
+#include "HPCLatencyHistogram.hpp"
+#include "HPCParameter.hpp"
+#include "HPCProfilePhase.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 処理の区分ごとの実行時間を、ステージごとに集計します。
+    ///
+    /// 時間は単調増加する高分解能の実時間で計測します。
+    /// 各処理の時間は ProfileProbe で計測し、ステージ全体の実時間と CPU 時間は
+    /// BeginStage と EndStage の間で計測します。
+    ///
+    /// 集計結果は Simulation ごとに保持し、 Game と Stage はそのポインタを参照します。
+    /// 集計しない場合はポインタが 0 になり、 ProfileProbe は時刻を読みません。
+    /// 並列実行時は、各ワーカーの結果を stage と setStage で受け渡します。
+    ///
+    /// setLatencyEnabled で有効にすると、 Answer::GetNextAction の1回ごとの
+    /// 応答時間の分布も記録します。
+    class Profiler
+    {
+    public:
+        /// 1ステージ分の集計結果
+        struct StageData
+        {
+            double phaseSec[ProfilePhase_TERM];     ///< 各処理の実時間の合計
+            int phaseCount[ProfilePhase_TERM];      ///< 各処理の計測回数
+            double wallSec;                         ///< ステージ全体の実時間
+            double cpuSec;                          ///< ステージ全体の CPU 時間
+            LatencyHistogram answerLatency;         ///< Answer::GetNextAction の応答時間の分布
+        };
+
+        Profiler();
+
+        void reset();                                       ///< 集計結果をすべて破棄します。
+        void beginStage(int aStageIndex);                   ///< ステージの計測を開始します。
+        void endStage();                                    ///< ステージの計測を終了します。
+        void add(ProfilePhase aPhase, double aSec);         ///< 現在のステージに処理の時間を加算します。
+        void setLatencyEnabled(bool aIsEnabled);            ///< 応答時間の分布を記録するかを設定します。
+        bool isLatencyEnabled()const;                      ///< 応答時間の分布を記録するかを返します。
+
+        /// @name 集計結果の取得と設定
+        //@{
+        const StageData& stage(int aStageIndex)const;      ///< ステージの集計結果を返します。
+        void setStage(int aStageIndex, const StageData& aData); ///< ステージの集計結果を設定します。
+        //@}
+
+        /// 集計結果を表で出力します。
+        void print(int aStageBegin, int aStageEnd)const;
+        /// 応答時間の分布を表で出力します。
+        void printLatency(int aStageBegin, int aStageEnd)const;
+
+        static double NowSec();                             ///< 計測に使用する現在時刻を返します。
+
+    private:
+        StageData mStages[Parameter::GameStageCount];   ///< 各ステージの集計結果
+        bool mIsLatencyEnabled;                         ///< 応答時間の分布を記録するか
+        int mCurrentStage;                              ///< 計測中のステージ番号。計測していなければ -1
+        double mStageBeginSec;                          ///< 計測中のステージを開始した時刻
+        std::clock_t mStageBeginClock;                  ///< 計測中のステージを開始した CPU 時間
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
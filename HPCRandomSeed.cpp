@@ -25,6 +25,34 @@ namespace {
     const uint DefaultSeedZ = 3684690907u;
     const uint DefaultSeedW = 3549078838u;
     //@}
+
+    //------------------------------------------------------------------------------
+    /// 32bit 値のビットを撹拌します。
+    ///
+    /// @param[in] aValue 撹拌する値。
+    ///
+    /// @return 撹拌した値。入力が 1bit 変わると、出力の各ビットがおよそ半分の確率で変わります。
+    uint Mix(uint aValue)
+    {
+        aValue ^= aValue >> 16;
+        aValue *= 0x7FEB352Du;
+        aValue ^= aValue >> 15;
+        aValue *= 0x846CA68Bu;
+        aValue ^= aValue >> 16;
+        return aValue;
+    }
+
+    //------------------------------------------------------------------------------
+    /// splitmix 方式で状態を一定量進め、撹拌した値を返します。
+    ///
+    /// @param[in,out] aState 状態。
+    ///
+    /// @return 生成した値。
+    uint SplitMix(uint& aState)
+    {
+        aState += 0x9E3779B9u;
+        return Mix(aState);
+    }
 }
 
 namespace hpc {
@@ -47,6 +75,36 @@ namespace hpc {
     {
     }
 
+    //------------------------------------------------------------------------------
+    /// このシードと番号から、派生したシードを計算します。
+    ///
+    /// シードの全要素と番号を撹拌して状態を作り、 splitmix 方式で各要素を生成します。
+    /// 番号が隣り合っていても、派生したシード同士には相関がありません。
+    ///
+    /// @param[in] aIndex 番号。ステージ番号などを指定します。
+    ///
+    /// @return 派生したシード。
+    RandomSeed RandomSeed::derive(int aIndex)const
+    {
+        uint state = Mix(Mix(Mix(Mix(x) ^ y) ^ z) ^ w);
+        state ^= Mix(static_cast<uint>(aIndex) + 0x6A09E667u);
+
+        RandomSeed seed;
+        seed.x = SplitMix(state);
+        seed.y = SplitMix(state);
+        seed.z = SplitMix(state);
+        seed.w = SplitMix(state);
+
+        // xorshift は状態がすべてゼロだと乱数列が進まないため避ける
+        if (seed.x == 0 && seed.y == 0) {
+            seed.x = DefaultSeedX;
+        }
+        if (seed.z == 0 && seed.w == 0) {
+            seed.z = DefaultSeedZ;
+        }
+        return seed;
+    }
+
 }
 //------------------------------------------------------------------------------
 // EOF
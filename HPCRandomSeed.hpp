@@ -22,6 +22,8 @@ namespace hpc {
         RandomSeed();
         RandomSeed(uint x, uint y, uint z, uint w);
 
+        RandomSeed derive(int aIndex)const;    ///< 番号に対応する派生シードを返します。
+
         uint x;
         uint y;
         uint z;
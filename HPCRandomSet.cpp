@@ -12,6 +12,7 @@
 #include "HPCRandomSet.hpp"
 
 #include "HPCCommon.hpp"
+#include "HPCParameter.hpp"
 
 namespace hpc {
     //------------------------------------------------------------------------------
@@ -19,11 +20,29 @@ namespace hpc {
     ///
     /// @param[in] aSeed 乱数のシードを表す構造体。
     RandomSet::RandomSet(const RandomSeed& aSeed)
-        : mSystem(aSeed.x, aSeed.y)
+        : mSeed(aSeed)
+        , mSystem(aSeed.x, aSeed.y)
         , mGame(aSeed.z, aSeed.w)
     {
     }
 
+    //------------------------------------------------------------------------------
+    /// シードとステージ番号のみから決まる乱数列を、システムとゲーム中に
+    /// 使用する乱数列として設定します。
+    ///
+    /// ステージの生成や CPU の行動で消費される乱数の数は、ステージごとに異なります。
+    /// ステージごとに乱数列を設定し直すことで、前のステージを実行せずに
+    /// 任意のステージを単独で再現できるようになります。
+    ///
+    /// @param[in] aStageIndex ステージ番号。
+    void RandomSet::setupStage(int aStageIndex)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        const RandomSeed seed = mSeed.derive(aStageIndex);
+        mSystem = Random(seed.x, seed.y);
+        mGame = Random(seed.z, seed.w);
+    }
+
     //------------------------------------------------------------------------------
     /// @return システムで使用する乱数生成クラス
     Random& RandomSet::system()
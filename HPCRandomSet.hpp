@@ -22,6 +22,8 @@ namespace hpc {
     public:
         explicit RandomSet(const RandomSeed& aSeed = RandomSeed());
 
+        void setupStage(int aStageIndex);   ///< ステージ専用の乱数列を設定します。
+
         /// @name 各要素へのアクセス
         //@{
         Random& system();               ///< システムで使用するインスタンスを返します。
@@ -29,6 +31,7 @@ namespace hpc {
         //@}
 
     private:
+        RandomSeed mSeed;       ///< 乱数のシード
         Random mSystem;         ///< システムで使用する乱数生成クラス
         Random mGame;           ///< ゲーム中に使用する乱数生成クラス
     };
@@ -12,6 +12,12 @@
 #include "HPCRecord.hpp"
 
 #include "HPCCommon.hpp"
+#include "HPCJsonWriter.hpp"
+#include "HPCRecordSink.hpp"
+#include "HPCReplay.hpp"
+#include "HPCReplayReader.hpp"
+#include "HPCReplayWriter.hpp"
+#include "HPCWorkerPool.hpp"
 
 namespace hpc {
 
@@ -20,9 +26,18 @@ namespace hpc {
     Record::Record()
         : mStage()
         , mCurrentStageIndex(0)
+        , mSink(0)
+        , mTurnBuffer(0)
     {
     }
 
+    //------------------------------------------------------------------------------
+    /// 確保した領域を解放して、インスタンスを破棄します。
+    Record::~Record()
+    {
+        releaseTurnBuffer();
+    }
+
     //------------------------------------------------------------------------------
     /// ステージ開始時に一度呼ぶことで、ステージ開始を記録します。
     ///
@@ -36,6 +51,9 @@ namespace hpc {
 
         mCurrentStageIndex = aStageIndex;
         mStage[mCurrentStageIndex].writeStart(aStage);
+        if (mSink) {
+            mSink->writeStartStage(aStageIndex, aStage);
+        }
     }
     
     //------------------------------------------------------------------------------
@@ -47,6 +65,9 @@ namespace hpc {
     void Record::writeTurn(const TurnResult& aResult)
     {
         mStage[mCurrentStageIndex].writeTurn(aResult);
+        if (mSink) {
+            mSink->writeTurn(aResult);
+        }
     }
 
     //------------------------------------------------------------------------------
@@ -58,6 +79,25 @@ namespace hpc {
     void Record::writeEndStage(const Stage& aStage)
     {
         mStage[mCurrentStageIndex].writeEnd(aStage);
+        if (mSink) {
+            mSink->writeEndStage(mStage[mCurrentStageIndex]);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 別の Record で記録されたステージの記録を、そのまま設定します。
+    /// 並列実行したステージの結果を集める際に使用します。
+    ///
+    /// @param[in] aStageIndex  ステージ番号。
+    /// @param[in] aStage       ステージの記録。
+    ///
+    /// @pre ステージ番号は有効な範囲を示している必要があります。
+    void Record::writeStage(int aStageIndex, const RecordStage& aStage)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        mStage[aStageIndex] = aStage;
+        // ターンの内容は共有された記録先に書き込まれているため、記録先は自分のものにしておく
+        mStage[aStageIndex].setTurnBuffer(turnBuffer(aStageIndex));
     }
 
     //------------------------------------------------------------------------------
@@ -79,6 +119,16 @@ namespace hpc {
         return static_cast<int>(total);
     }
 
+    //------------------------------------------------------------------------------
+    /// @param[in] aStageIndex ステージ番号。有効な範囲の番号が指定される必要があります。
+    ///
+    /// @return 指定されたステージの記録。
+    const RecordStage& Record::stage(int aStageIndex)const
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        return mStage[aStageIndex];
+    }
+
     //------------------------------------------------------------------------------
     /// 引数に指定されたステージの記録を一覧形式で画面に表示します。
     /// 記録がされていないステージの番号を指定した場合は何も表示されません。
@@ -102,7 +152,8 @@ namespace hpc {
     void Record::dumpJsonStage(int aStageIndex)const
     {
         HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
-        mStage[aStageIndex].dumpJson(false);
+        JsonWriter writer(stdout, false);
+        mStage[aStageIndex].dumpJson(writer);
     }
 
     //------------------------------------------------------------------------------
@@ -114,47 +165,178 @@ namespace hpc {
     ///                         形で出力されます。
     void Record::dumpJson(bool isCompressed)const
     {
-        HPC_PRINT("[");
-        HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+        JsonWriter writer(stdout, isCompressed);
+        dumpJson(writer);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ゲームの全情報を含む JSON データを出力します。
+    ///
+    /// @param[in,out] aWriter JSON の出力先。
+    void Record::dumpJson(JsonWriter& aWriter)const
+    {
+        aWriter.write("[");
+        aWriter.writeDebug("\n");
 
             // 基本情報
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "    "); // インデント (4)
-            HPC_PRINT("[");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+            aWriter.writeDebug("    "); // インデント (4)
+            aWriter.write("[");
+            aWriter.writeDebug("\n");
 
                 // 忍者半径
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "        "); // インデント (8)
-                HPC_PRINT("%7.3f,", Parameter::CharaRadius());
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("        "); // インデント (8)
+                aWriter.writeFixed(Parameter::CharaRadius(), 7, 3);
+                aWriter.write(",");
+                aWriter.writeDebug("\n");
 
                 // 必要周回数
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "        "); // インデント (8)
-                HPC_PRINT("%d", Parameter::StageRoundCount);
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("        "); // インデント (8)
+                aWriter.writeInt(Parameter::StageRoundCount);
+                aWriter.writeDebug("\n");
 
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "    "); // インデント (4)
-            HPC_PRINT("],");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+            aWriter.writeDebug("    "); // インデント (4)
+            aWriter.write("],");
+            aWriter.writeDebug("\n");
 
             // ステージ情報表示
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "    "); // インデント (4)
-            HPC_PRINT("[");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+            aWriter.writeDebug("    "); // インデント (4)
+            aWriter.write("[");
+            aWriter.writeDebug("\n");
 
             for (int index = 0; index < Parameter::GameStageCount; ++index) {
-                mStage[index].dumpJson(isCompressed);
+                mStage[index].dumpJson(aWriter);
                 if (index + 1 < Parameter::GameStageCount) {
-                    HPC_PRINT(",");
+                    aWriter.write(",");
                 }
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("\n");
+            }
+
+            aWriter.writeDebug("    "); // インデント (4)
+            aWriter.write("]");
+            aWriter.writeDebug("\n");
+
+        aWriter.writeDebug("\n");
+        aWriter.write("]\n");
+    }
+
+    //------------------------------------------------------------------------------
+    /// ゲームの全記録をリプレイファイルとして書き込みます。
+    /// 書式は Replay クラスの説明を参照してください。
+    ///
+    /// @param[in,out] aWriter 書き込み先。
+    void Record::writeReplay(ReplayWriter& aWriter)const
+    {
+        aWriter.writeHeader();
+        for (int index = 0; index < Parameter::GameStageCount; ++index) {
+            mStage[index].writeReplay(index, aWriter);
+        }
+        aWriter.writeEnd(score());
+    }
+
+    //------------------------------------------------------------------------------
+    /// リプレイファイルから全記録を読み込みます。
+    /// リプレイファイルに含まれないステージは、実行されなかったものとして扱います。
+    ///
+    /// @param[in,out] aReader 読み込み元。
+    ///
+    /// @return 正しく読み込めた場合は @c true を返します。
+    ///         異なるバージョンやステージ数のファイルは読み込めません。
+    bool Record::readReplay(ReplayReader& aReader)
+    {
+        if (!aReader.readHeader()) {
+            return false;
+        }
+
+        setupTurnBuffer();
+        for (int index = 0; index < Parameter::GameStageCount; ++index) {
+            mStage[index] = RecordStage();
+            mStage[index].setTurnBuffer(turnBuffer(index));
+        }
+        while (aReader.readBlockType() == Replay::BlockStage) {
+            int stageIndex = 0;
+            int charaCount = 0;
+            bool hasDetail = false;
+            aReader.readStageStart(stageIndex, charaCount, hasDetail);
+            if (!mStage[stageIndex].readReplay(charaCount, hasDetail, aReader)) {
+                return false;
             }
+            mCurrentStageIndex = stageIndex;
+        }
+        aReader.readEnd();
+        return aReader.isValid();
+    }
 
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "    "); // インデント (4)
-            HPC_PRINT("]");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+    //------------------------------------------------------------------------------
+    /// 記録の送り先を設定します。
+    ///
+    /// 送り先を設定すると、各ターンの内容はメモリに記録されず、送り先へ送られます。
+    /// JSON の出力やデバッガでは、ターンの内容は表示されなくなります。
+    ///
+    /// @param[in] aSink 記録の送り先。 0 を指定すると、メモリに記録する動作に戻ります。
+    void Record::setSink(RecordSink* aSink)
+    {
+        mSink = aSink;
+        if (mSink) {
+            releaseTurnBuffer();
+        }
+    }
 
-        HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
-        HPC_PRINT("]\n");
+    //------------------------------------------------------------------------------
+    /// 各ターンの内容を記録する領域を確保します。
+    ///
+    /// 領域はワーカーと共有するメモリに確保するため、ワーカーを起動する前に
+    /// 確保しておくと、各ワーカーが記録したターンの内容をそのまま参照できます。
+    /// 送り先が設定されている場合や、定数 DEBUG が定義されていない場合は何もしません。
+    void Record::setupTurnBuffer()
+    {
+#ifdef DEBUG
+        if (mSink || mTurnBuffer) {
+            return;
+        }
+        mTurnBuffer = static_cast<TurnResult*>(WorkerPool::AllocShared(TurnBufferSize));
+        if (!mTurnBuffer) {
+            HPC_PRINT("Failed to allocate the turn record. Turns are not recorded.\n");
+            return;
+        }
+        for (int index = 0; index < Parameter::GameStageCount; ++index) {
+            mStage[index].setTurnBuffer(turnBuffer(index));
+        }
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// ゲームの終了を記録します。
+    void Record::writeEndGame()
+    {
+        if (mSink) {
+            mSink->writeEndGame(score());
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各ターンの内容を記録する領域を解放します。
+    void Record::releaseTurnBuffer()
+    {
+        if (!mTurnBuffer) {
+            return;
+        }
+        for (int index = 0; index < Parameter::GameStageCount; ++index) {
+            mStage[index].setTurnBuffer(0);
+        }
+        WorkerPool::FreeShared(mTurnBuffer, TurnBufferSize);
+        mTurnBuffer = 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aStageIndex ステージ番号。
+    ///
+    /// @return 指定したステージの各ターンの記録先。領域が無い場合は 0 を返します。
+    TurnResult* Record::turnBuffer(int aStageIndex)const
+    {
+        if (!mTurnBuffer) {
+            return 0;
+        }
+        return mTurnBuffer + aStageIndex * RecordStage::TurnCountMax;
     }
 }
 
@@ -16,31 +16,62 @@
 
 namespace hpc {
 
+    class JsonWriter;
+    class RecordSink;
+    class ReplayReader;
+    class ReplayWriter;
+
     //------------------------------------------------------------------------------
     /// ゲームの記録を保持します。
+    ///
+    /// 各ターンの内容は、送り先が設定されていればそこへ送り、
+    /// 設定されていなければ setupTurnBuffer で確保した領域に記録します。
     class Record 
     {
     public:
         Record();
+        ~Record();
+
+        void setSink(RecordSink* aSink);                            ///< 記録の送り先を設定します。
+        void setupTurnBuffer();                                     ///< 各ターンの記録先を確保します。
 
         /// @name 記録動作を行う関数
         //@{
         void writeStartStage(int aStageIndex, const Stage& aStage); ///< ステージの記録を開始します。
         void writeTurn(const TurnResult& aResult);                  ///< 各ターンの結果を記録します。
         void writeEndStage(const Stage& aStage);                    ///< 終了時の結果を記録します。
+        void writeStage(int aStageIndex, const RecordStage& aStage); ///< ステージの記録をまとめて設定します。
+        void writeEndGame();                                        ///< ゲームの終了を記録します。
         //@}
 
         /// @name 記録を読み出す関数
         //@{
         int score()const;                                  ///< 合計得点を取得します。
+        const RecordStage& stage(int aStageIndex)const;    ///< ステージの記録を取得します。
         void dumpStage(int aStageIndex)const;              ///< ステージの結果を出力します。
         void dumpJsonStage(int aStageIndex)const;          ///< ステージの結果を JSON で出力します。
         void dumpJson(bool isCompressed)const;             ///< 全結果を JSON で出力します。
+        void dumpJson(JsonWriter& aWriter)const;           ///< 全結果を JSON で指定の出力先に出力します。
+        void writeReplay(ReplayWriter& aWriter)const;      ///< 全結果をリプレイファイルに書き込みます。
         //@}
 
+        bool readReplay(ReplayReader& aReader);            ///< リプレイファイルから記録を読み込みます。
+
     private:
+        /// 各ターンの記録先のバイト数
+        static const int TurnBufferSize = static_cast<int>(sizeof(TurnResult)) * RecordStage::TurnCountMax * Parameter::GameStageCount;
+
         RecordStage mStage[Parameter::GameStageCount];    ///< ステージごとのデータ
         int mCurrentStageIndex;                             ///< 現在のステージ番号
+        RecordSink* mSink;                                  ///< 記録の送り先
+        TurnResult* mTurnBuffer;                            ///< 各ターンの記録先
+
+        void releaseTurnBuffer();
+        TurnResult* turnBuffer(int aStageIndex)const;
+
+        // 記録先を所有しているため、コピーは禁止します。
+        Record(const Record&);
+        Record& operator=(const Record&);
     };
 }
 //------------------------------------------------------------------------------
@@ -0,0 +1,260 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCRecordSink.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCRecordSink.hpp"
+
+#include "HPCCommon.hpp"
+#include "HPCMath.hpp"
+#include "HPCRecordStage.hpp"
+#include "HPCStage.hpp"
+
+#if defined(_WIN32)
+    #define HPC_POPEN _popen
+    #define HPC_PCLOSE _pclose
+#else
+    #define HPC_POPEN popen
+    #define HPC_PCLOSE pclose
+#endif
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 何もしない送り先としてインスタンスを生成します。
+    RecordSink::RecordSink()
+        : mType(RecordSinkType_Null)
+        , mFile(0)
+        , mWriter(0)
+        , mRing()
+        , mRingCount(0)
+        , mStageIndex(0)
+        , mCharaCount(0)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 送り先が開かれていれば閉じてから、インスタンスを破棄します。
+    RecordSink::~RecordSink()
+    {
+        close();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 送られた記録を捨てる送り先にします。
+    void RecordSink::setupNull()
+    {
+        close();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各ステージの直近 RingTurnCount ターンだけを保持する送り先にします。
+    /// 保持した内容は dumpRing で表示できます。
+    void RecordSink::setupRingBuffer()
+    {
+        close();
+        mType = RecordSinkType_RingBuffer;
+        mRingCount = 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ファイルを開き、リプレイ形式で書き出す送り先にします。
+    ///
+    /// @param[in] aPath 書き出すファイルのパス。
+    ///
+    /// @return ファイルを開けた場合は @c true を返します。
+    bool RecordSink::openFile(const char* aPath)
+    {
+        close();
+        mFile = std::fopen(aPath, "wb");
+        if (!mFile) {
+            return false;
+        }
+        mType = RecordSinkType_File;
+        mWriter.setup(mFile);
+        mWriter.writeHeader();
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /// コマンドを起動し、その標準入力へリプレイ形式で書き出す送り先にします。
+    ///
+    /// @param[in] aCommand 起動するコマンド。
+    ///
+    /// @return コマンドを起動できた場合は @c true を返します。
+    bool RecordSink::openPipe(const char* aCommand)
+    {
+        close();
+        std::fflush(stdout);
+        mFile = HPC_POPEN(aCommand, "w");
+        if (!mFile) {
+            return false;
+        }
+        mType = RecordSinkType_Pipe;
+        mWriter.setup(mFile);
+        mWriter.writeHeader();
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 書き出していないデータを出力して送り先を閉じ、何もしない送り先に戻します。
+    ///
+    /// @return それまでの書き出しがすべて成功していた場合は @c true を返します。
+    bool RecordSink::close()
+    {
+        bool isSucceeded = true;
+        if (mFile) {
+            isSucceeded = mWriter.flush();
+            if (mType == RecordSinkType_Pipe) {
+                isSucceeded = (HPC_PCLOSE(mFile) == 0) && isSucceeded;
+            } else {
+                isSucceeded = (std::fclose(mFile) == 0) && isSucceeded;
+            }
+            mFile = 0;
+            mWriter.setup(0);
+        }
+        mType = RecordSinkType_Null;
+        return isSucceeded;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの開始を送ります。
+    ///
+    /// @param[in] aStageIndex ステージ番号。
+    /// @param[in] aStage      開始したステージ。
+    void RecordSink::writeStartStage(int aStageIndex, const Stage& aStage)
+    {
+        mStageIndex = aStageIndex;
+        mCharaCount = aStage.charas().count();
+        switch (mType) {
+        case RecordSinkType_Null:
+            break;
+
+        case RecordSinkType_File:
+        case RecordSinkType_Pipe:
+            {
+                Vec2 initPositions[Parameter::CharaCountMax];
+                for (int index = 0; index < mCharaCount; ++index) {
+                    initPositions[index] = aStage.charas()[index].pos();
+                }
+                mWriter.writeStageStart(aStageIndex, mCharaCount, true);
+                mWriter.writeStageDetail(aStage.field(), aStage.lotuses(), initPositions);
+            }
+            break;
+
+        case RecordSinkType_RingBuffer:
+            mRingCount = 0;
+            break;
+
+        default:
+            HPC_SHOULD_NOT_REACH_HERE();
+            break;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各ターンの結果を送ります。
+    ///
+    /// @param[in] aResult ターンの実行結果。
+    void RecordSink::writeTurn(const TurnResult& aResult)
+    {
+        switch (mType) {
+        case RecordSinkType_Null:
+            break;
+
+        case RecordSinkType_File:
+        case RecordSinkType_Pipe:
+            mWriter.writeTurn(aResult);
+            break;
+
+        case RecordSinkType_RingBuffer:
+            mRing[mRingCount % RingTurnCount].set(aResult);
+            ++mRingCount;
+            break;
+
+        default:
+            HPC_SHOULD_NOT_REACH_HERE();
+            break;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの結果を送ります。
+    ///
+    /// @param[in] aStage 終了したステージの記録。
+    void RecordSink::writeEndStage(const RecordStage& aStage)
+    {
+        if (mType == RecordSinkType_File || mType == RecordSinkType_Pipe) {
+            aStage.writeReplayResult(mWriter);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// ゲームの終了を送ります。
+    ///
+    /// @param[in] aScore 合計得点。
+    void RecordSink::writeEndGame(int aScore)
+    {
+        if (mType == RecordSinkType_File || mType == RecordSinkType_Pipe) {
+            mWriter.writeEnd(aScore);
+            mWriter.flush();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 送り先の種類。
+    RecordSinkType RecordSink::type()const
+    {
+        return mType;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return これまでの書き出しがすべて成功していれば @c true を返します。
+    ///         ファイルとパイプ以外では常に @c true です。
+    bool RecordSink::isValid()const
+    {
+        if (mType == RecordSinkType_File || mType == RecordSinkType_Pipe) {
+            return mWriter.isValid();
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return ファイルかパイプへ書き出した総バイト数。それ以外では 0 です。
+    int RecordSink::writtenSize()const
+    {
+        return mWriter.writtenSize();
+    }
+
+    //------------------------------------------------------------------------------
+    /// リングバッファに保持している、最後に送られたステージの直近のターンを表示します。
+    void RecordSink::dumpRing()const
+    {
+        if (mType != RecordSinkType_RingBuffer) {
+            return;
+        }
+        const int keptCount = Math::Min(mRingCount, RingTurnCount);
+        HPC_PRINT_LOG("Stage", "%d (last %d turns)\n", mStageIndex, keptCount);
+        for (int turn = mRingCount - keptCount; turn < mRingCount; ++turn) {
+            const TurnResult& result = mRing[turn % RingTurnCount];
+            HPC_PRINT_LOG("Turn", "#%04d:", turn);
+            for (int index = 0; index < mCharaCount; ++index) {
+                HPC_PRINT(
+                    " [%7.2f,%7.2f]"
+                    , result.charas[index].pos.x
+                    , result.charas[index].pos.y
+                    );
+            }
+            HPC_PRINT("\n");
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    RecordSink クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+#include "HPCRecordSinkType.hpp"
+#include "HPCReplayWriter.hpp"
+#include "HPCTurnResult.hpp"
+
+namespace hpc {
+
+    class RecordStage;
+    class Stage;
+
+    //------------------------------------------------------------------------------
+    /// ゲームの記録を、実行しながら逐次受け取る送り先を表します。
+    ///
+    /// Record に設定すると、各ターンの内容はメモリに保持されずにこのクラスへ送られ、
+    /// Record には得点の計算に必要なステージごとの概要のみが残ります。
+    /// そのため、ステージ数やターン数によらずメモリの使用量が一定になります。
+    ///
+    /// ファイルとパイプへは Replay クラスで説明しているリプレイ形式で書き出すため、
+    /// 書き出したデータは ReplayReader で読み込むことができます。
+    class RecordSink
+    {
+    public:
+        static const int RingTurnCount = 64;            ///< リングバッファに保持するターン数
+
+        RecordSink();
+        ~RecordSink();
+
+        /// @name 送り先の設定
+        //@{
+        void setupNull();                               ///< 何もしない送り先にします。
+        void setupRingBuffer();                         ///< 直近のターンを保持する送り先にします。
+        bool openFile(const char* aPath);               ///< ファイルを送り先にします。
+        bool openPipe(const char* aCommand);            ///< 起動したコマンドの標準入力を送り先にします。
+        bool close();                                   ///< 送り先を閉じ、何もしない送り先に戻します。
+        //@}
+
+        /// @name 記録の送信
+        //@{
+        void writeStartStage(int aStageIndex, const Stage& aStage); ///< ステージの開始を送ります。
+        void writeTurn(const TurnResult& aResult);                  ///< 各ターンの結果を送ります。
+        void writeEndStage(const RecordStage& aStage);              ///< ステージの結果を送ります。
+        void writeEndGame(int aScore);                              ///< ゲームの終了を送ります。
+        //@}
+
+        RecordSinkType type()const;                     ///< 送り先の種類を返します。
+        bool isValid()const;                            ///< これまでの送信が成功しているかを返します。
+        int writtenSize()const;                         ///< 書き出した総バイト数を返します。
+        void dumpRing()const;                           ///< リングバッファの内容を画面に表示します。
+
+    private:
+        RecordSinkType mType;                           ///< 送り先の種類
+        std::FILE* mFile;                               ///< ファイルかパイプの出力先
+        ReplayWriter mWriter;                           ///< リプレイ形式の書き込み
+        TurnResult mRing[RingTurnCount];                ///< 直近のターンの結果
+        int mRingCount;                                 ///< 送られたターン数
+        int mStageIndex;                                ///< 送られているステージ番号
+        int mCharaCount;                                ///< 送られているステージのキャラ数
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,27 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    RecordSinkType 列挙型
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// @brief 記録の送り先の種類を定義します。
+    enum RecordSinkType {
+        RecordSinkType_Null,        ///< 何もしない
+        RecordSinkType_File,        ///< ファイルにリプレイ形式で書き出す
+        RecordSinkType_Pipe,        ///< 他のプロセスにリプレイ形式で送る
+        RecordSinkType_RingBuffer,  ///< 直近のターンのみをメモリに保持する
+
+        RecordSinkType_TERM
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
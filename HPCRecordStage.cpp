@@ -12,7 +12,11 @@
 #include "HPCRecordStage.hpp"
 
 #include "HPCCommon.hpp"
+#include "HPCJsonWriter.hpp"
 #include "HPCLevelDesigner.hpp"
+#include "HPCReplay.hpp"
+#include "HPCReplayReader.hpp"
+#include "HPCReplayWriter.hpp"
 
 namespace hpc {
 
@@ -24,7 +28,7 @@ namespace hpc {
         , mPassedLotusCount(0)
         , mCharaCount(0)
 #ifdef DEBUG
-        , mTurns()
+        , mTurns(0)
         , mField()
         , mLotuses()
         , mInitPositions()
@@ -33,12 +37,31 @@ namespace hpc {
     {
     }
 
+    //------------------------------------------------------------------------------
+    /// 各ターンの内容を記録する領域を設定します。
+    ///
+    /// 記録先が設定されていない場合は、得点の計算に必要な概要のみを記録します。
+    /// 各ターンの内容は、定数 DEBUG が定義されている場合にのみ記録されます。
+    ///
+    /// @param[in] aTurns TurnCountMax 個の要素を持つ配列。 0 を指定すると記録しません。
+    void RecordStage::setTurnBuffer(TurnResult* aTurns)
+    {
+#ifdef DEBUG
+        mTurns = aTurns;
+#else
+        (void)aTurns;
+#endif
+    }
+
     //------------------------------------------------------------------------------
     /// ステージの記録を開始することを通知します。
     ///
     /// @param[in] aStage 現在実行しているステージを表す Stage クラスへの参照。
     void RecordStage::writeStart(const Stage& aStage)
     {
+        // 同じインスタンスで再度記録する場合に備え、前回の記録を破棄する
+        mCurrentTurn = 0;
+        mIsFailed = false;
         mCharaCount = aStage.charas().count();
         
 #ifdef DEBUG
@@ -57,8 +80,10 @@ namespace hpc {
     void RecordStage::writeTurn(const TurnResult& aResult)
     {
 #ifdef DEBUG
-        HPC_RANGE_ASSERT_MIN_UB_I(mCurrentTurn, 0, HPC_ARRAY_NUM(mTurns));
-        mTurns[mCurrentTurn].set(aResult);
+        HPC_RANGE_ASSERT_MIN_UB_I(mCurrentTurn, 0, TurnCountMax);
+        if (mTurns) {
+            mTurns[mCurrentTurn].set(aResult);
+        }
 #endif
         ++mCurrentTurn;
         // 得点計算のため、失敗したことを記録しておく。
@@ -94,6 +119,10 @@ namespace hpc {
         // 通過蓮スコア × (通過蓮スコア / クリアに掛かったターン数) × 一定の係数
         // × 順位による倍率
         // で求める。
+        // 実行されなかったステージは得点なし
+        if (mCharaCount == 0) {
+            return 0;
+        }
         static const int Value = 250;
         static const double RankRateTable[Parameter::CharaCountMax] = {
             6.0
@@ -134,7 +163,8 @@ namespace hpc {
             HPC_PRINT_LOG("Lotus", "#%3d: (%7.2f,%7.2f) R=%7.2f\n", 
                 index, lotusRegion.pos().x, lotusRegion.pos().y, lotusRegion.radius());
         }
-        for (int index = 0; index < mCurrentTurn; ++index) {
+        const int turnCount = recordedTurnCount();
+        for (int index = 0; index < turnCount; ++index) {
             const TurnResult& turn = mTurns[index];
             HPC_PRINT_LOG("Turn", "#%04d: ", index);
             switch(turn.state) {
@@ -176,156 +206,250 @@ namespace hpc {
     //------------------------------------------------------------------------------
     /// 記録された結果をJSON形式で出力します。
     ///
-    /// @param[in] isCompressed 圧縮された状態で出力するかどうか。
-    ///                         @c true にすると、改行やインデントを除いた形で出力されます。
-    void RecordStage::dumpJson(bool isCompressed)const
+    /// @param[in,out] aWriter JSON の出力先。
+    ///                        圧縮する設定の場合は、改行やインデントを除いた形で出力されます。
+    void RecordStage::dumpJson(JsonWriter& aWriter)const
     {
 #ifdef DEBUG
-        HPC_PRINT_JSON_DEBUG(!isCompressed, "        "); // インデント (8)
-        HPC_PRINT("[");
-        HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+        aWriter.writeDebug("        "); // インデント (8)
+        aWriter.write("[");
+        aWriter.writeDebug("\n");
 
             // 初期状態情報
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "            "); // インデント (12)
-            HPC_PRINT("[");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+            aWriter.writeDebug("            "); // インデント (12)
+            aWriter.write("[");
+            aWriter.writeDebug("\n");
 
                 // フィールド情報
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("%7.3f,%7.3f,", mField.rect().width(), mField.rect().height());
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.writeFixed(mField.rect().width(), 7, 3);
+                aWriter.write(",");
+                aWriter.writeFixed(mField.rect().height(), 7, 3);
+                aWriter.write(",");
+                aWriter.writeDebug("\n");
 
                 // 蓮情報
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("[");
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.write("[");
+                aWriter.writeDebug("\n");
 
                 for (int lotusIndex = 0; lotusIndex < mLotuses.count(); ++lotusIndex) {
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "                    "); // インデント (20)
-                    HPC_PRINT("[");
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
-                        HPC_PRINT_JSON_DEBUG(!isCompressed, "                        "); // インデント (24)
-                        HPC_PRINT(
-                            "%7.3f,%7.3f,%7.3f"
-                            , mLotuses[lotusIndex].pos().x
-                            , mLotuses[lotusIndex].pos().y
-                            , mLotuses[lotusIndex].radius()
-                            );
-                        HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "                    "); // インデント (20)
-                    HPC_PRINT("]");
+                    aWriter.writeDebug("                    "); // インデント (20)
+                    aWriter.write("[");
+                    aWriter.writeDebug("\n");
+                        aWriter.writeDebug("                        "); // インデント (24)
+                        aWriter.writeFixed(mLotuses[lotusIndex].pos().x, 7, 3);
+                        aWriter.write(",");
+                        aWriter.writeFixed(mLotuses[lotusIndex].pos().y, 7, 3);
+                        aWriter.write(",");
+                        aWriter.writeFixed(mLotuses[lotusIndex].radius(), 7, 3);
+                        aWriter.writeDebug("\n");
+                    aWriter.writeDebug("                    "); // インデント (20)
+                    aWriter.write("]");
                     if (lotusIndex + 1 < mLotuses.count()) {
-                        HPC_PRINT(",");
+                        aWriter.write(",");
                     }
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                    aWriter.writeDebug("\n");
                 }
 
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("],");
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.write("],");
+                aWriter.writeDebug("\n");
 
                 // 順位情報
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("[");
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.write("[");
+                aWriter.writeDebug("\n");
 
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "                    "); // インデント (20)
+                    aWriter.writeDebug("                    "); // インデント (20)
                     for (int charaIndex = 0; charaIndex < mCharaCount; ++charaIndex) {
-                        HPC_PRINT("%d", mRanks[charaIndex]);
+                        aWriter.writeInt(mRanks[charaIndex]);
                         if (charaIndex < mCharaCount - 1) {
-                            HPC_PRINT(", ");
+                            aWriter.write(", ");
                         }
                     }
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                    aWriter.writeDebug("\n");
 
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("],");
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.write("],");
+                aWriter.writeDebug("\n");
 
                 // 流れる速度
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("%7.6f,", mField.flowVel().y);
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.writeFixed(mField.flowVel().y, 7, 6);
+                aWriter.write(",");
+                aWriter.writeDebug("\n");
 
                 // スコア
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("%d", static_cast<int>(score()));
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.writeInt(static_cast<int>(score()));
+                aWriter.writeDebug("\n");
 
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "            "); // インデント (12)
-            HPC_PRINT("],");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+            aWriter.writeDebug("            "); // インデント (12)
+            aWriter.write("],");
+            aWriter.writeDebug("\n");
 
             // ターン情報
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "            "); // インデント (12)
-            HPC_PRINT("[");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+            aWriter.writeDebug("            "); // インデント (12)
+            aWriter.write("[");
+            aWriter.writeDebug("\n");
 
-            for (int turn = 0; turn < mCurrentTurn; ++turn) {
+            const int turnCount = recordedTurnCount();
+            for (int turn = 0; turn < turnCount; ++turn) {
                 const TurnResult& s = mTurns[turn];
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("[");
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.write("[");
+                aWriter.writeDebug("\n");
 
                     // キャラ情報
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "                    "); // インデント (20)
-                    HPC_PRINT("[");
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                    aWriter.writeDebug("                    "); // インデント (20)
+                    aWriter.write("[");
+                    aWriter.writeDebug("\n");
 
                     for (int charaIndex = 0; charaIndex < mCharaCount; ++charaIndex) {
-                        HPC_PRINT_JSON_DEBUG(!isCompressed, "                        "); // インデント (24)
-                        HPC_PRINT("[");
-                        HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
-                            HPC_PRINT_JSON_DEBUG(!isCompressed, "                            "); // インデント (28)
-                            HPC_PRINT(
-                                "%7.3f,%7.3f,"
-                                , s.charas[charaIndex].pos.x
-                                , s.charas[charaIndex].pos.y
-                                );
-                            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
-                            HPC_PRINT_JSON_DEBUG(!isCompressed, "                            "); // インデント (28)
-                            HPC_PRINT(
-                                "%d,"
-                                , s.charas[charaIndex].accelCount
-                                );
-                            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
-                            HPC_PRINT_JSON_DEBUG(!isCompressed, "                            "); // インデント (28)
-                            HPC_PRINT(
-                                "%d"
-                                , s.charas[charaIndex].passedLotusCount
-                                );
-                            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
-                        HPC_PRINT_JSON_DEBUG(!isCompressed, "                        "); // インデント (24)
-                        HPC_PRINT("]");
+                        aWriter.writeDebug("                        "); // インデント (24)
+                        aWriter.write("[");
+                        aWriter.writeDebug("\n");
+                            aWriter.writeDebug("                            "); // インデント (28)
+                            aWriter.writeFixed(s.charas[charaIndex].pos.x, 7, 3);
+                            aWriter.write(",");
+                            aWriter.writeFixed(s.charas[charaIndex].pos.y, 7, 3);
+                            aWriter.write(",");
+                            aWriter.writeDebug("\n");
+                            aWriter.writeDebug("                            "); // インデント (28)
+                            aWriter.writeInt(s.charas[charaIndex].accelCount);
+                            aWriter.write(",");
+                            aWriter.writeDebug("\n");
+                            aWriter.writeDebug("                            "); // インデント (28)
+                            aWriter.writeInt(s.charas[charaIndex].passedLotusCount);
+                            aWriter.writeDebug("\n");
+                        aWriter.writeDebug("                        "); // インデント (24)
+                        aWriter.write("]");
                         if (charaIndex + 1 < mCharaCount) {
-                            HPC_PRINT(",");
+                            aWriter.write(",");
                         }
-                        HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                        aWriter.writeDebug("\n");
                     }
 
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "                    "); // インデント (20)
-                    HPC_PRINT("]");
-                    HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                    aWriter.writeDebug("                    "); // インデント (20)
+                    aWriter.write("]");
+                    aWriter.writeDebug("\n");
 
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "                "); // インデント (16)
-                HPC_PRINT("]");
-                if (turn + 1 < mCurrentTurn) {
-                    HPC_PRINT(",");
+                aWriter.writeDebug("                "); // インデント (16)
+                aWriter.write("]");
+                if (turn + 1 < turnCount) {
+                    aWriter.write(",");
                 }
-                HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+                aWriter.writeDebug("\n");
             }
 
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "            "); // インデント (12)
-            HPC_PRINT("]");
-            HPC_PRINT_JSON_DEBUG(!isCompressed, "\n");
+            aWriter.writeDebug("            "); // インデント (12)
+            aWriter.write("]");
+            aWriter.writeDebug("\n");
 
-        HPC_PRINT_JSON_DEBUG(!isCompressed, "        "); // インデント (8)
-        HPC_PRINT("]");
+        aWriter.writeDebug("        "); // インデント (8)
+        aWriter.write("]");
 #else
         // デバッグ無効の場合、json 出力はサポートされません。
-        HPC_PRINT("[]");
+        aWriter.write("[]");
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// 記録をリプレイファイルの 1 ステージ分のブロックとして書き込みます。
+    /// 書式は Replay クラスの説明を参照してください。
+    ///
+    /// @param[in]     aStageIndex ステージ番号。
+    /// @param[in,out] aWriter     書き込み先。
+    void RecordStage::writeReplay(int aStageIndex, ReplayWriter& aWriter)const
+    {
+#ifdef DEBUG
+        const bool hasDetail = (mTurns != 0);
+#else
+        const bool hasDetail = false;
+#endif
+        aWriter.writeStageStart(aStageIndex, mCharaCount, hasDetail);
+#ifdef DEBUG
+        if (hasDetail) {
+            aWriter.writeStageDetail(mField, mLotuses, mInitPositions);
+            for (int turn = 0; turn < mCurrentTurn; ++turn) {
+                aWriter.writeTurn(mTurns[turn]);
+            }
+        }
+#endif
+        writeReplayResult(aWriter);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの結果を書き込み、リプレイファイルのステージのブロックを終えます。
+    ///
+    /// @param[in,out] aWriter 書き込み先。
+    void RecordStage::writeReplayResult(ReplayWriter& aWriter)const
+    {
+        aWriter.writeStageEnd(mIsFailed, mPassedLotusCount, mCurrentTurn, mRanks);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ReplayReader::readStageStart の後に呼び、 1 ステージ分のブロックの残りを読み込みます。
+    ///
+    /// 詳細な記録は、定数 DEBUG が定義されていて、かつターンの記録先が
+    /// 設定されている場合にのみ保持されます。
+    ///
+    /// @param[in]     aCharaCount キャラ数。
+    /// @param[in]     aHasDetail  ブロックが詳細を含むか。
+    /// @param[in,out] aReader     読み込み元。
+    ///
+    /// @return 正しく読み込めた場合は @c true を返します。
+    bool RecordStage::readReplay(int aCharaCount, bool aHasDetail, ReplayReader& aReader)
+    {
+        mCharaCount = aCharaCount;
+        if (aHasDetail) {
+            Field field;
+            LotusCollection lotuses;
+            Vec2 initPositions[Parameter::CharaCountMax];
+            aReader.readStageDetail(field, lotuses, initPositions);
+
+            TurnResult result;
+            int turnCount = 0;
+            while (aReader.readTurn(result)) {
+                if (TurnCountMax <= turnCount) {
+                    return false;
+                }
+#ifdef DEBUG
+                if (mTurns) {
+                    mTurns[turnCount].set(result);
+                }
+#endif
+                ++turnCount;
+            }
+#ifdef DEBUG
+            mField.set(field);
+            mLotuses.set(lotuses);
+            for (int index = 0; index < mCharaCount; ++index) {
+                mInitPositions[index] = initPositions[index];
+            }
+#endif
+        }
+        aReader.readStageEnd(mIsFailed, mPassedLotusCount, mCurrentTurn, mRanks);
+#ifdef DEBUG
+        if (!aHasDetail && mTurns) {
+            // ターンの内容が無いため、前回の記録が残らないよう初期状態にしておく
+            for (int turn = 0; turn < mCurrentTurn && turn < TurnCountMax; ++turn) {
+                mTurns[turn].reset();
+            }
+        }
 #endif
+        return aReader.isValid();
     }
+
+#ifdef DEBUG
+    //------------------------------------------------------------------------------
+    /// @return 内容を参照できるターン数。記録先が無い場合は 0 です。
+    int RecordStage::recordedTurnCount()const
+    {
+        return mTurns ? mCurrentTurn : 0;
+    }
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -17,20 +17,33 @@
 
 namespace hpc {
 
+    class JsonWriter;
+    class ReplayReader;
+    class ReplayWriter;
+
     //------------------------------------------------------------------------------
     /// @brief 各ステージの記録を表します。
     class RecordStage 
     {
     public:
+        /// 1 ステージで記録するターン数の上限。初期状態を含めるので1多くとる。
+        static const int TurnCountMax = Parameter::GameTurnPerStage + 1;
+
         RecordStage();
 
+        void setTurnBuffer(TurnResult* aTurns);             ///< 各ターンの内容の記録先を設定します。
         void writeStart(const Stage& aStage);               ///< 記録を開始します。
         void writeTurn(const TurnResult& aResult);          ///< 各ターンの内容を記録します。
         void writeEnd(const Stage& aStage);                 ///< 終了時の内容を記録します。
 
         double score()const;                               ///< ステージ毎の得点を返します。
         void dump()const;                                  ///< 実行結果を画面に表示します。
-        void dumpJson(bool aIsCompressed)const;            ///< 実行結果を JSON 形式で画面に表示します。
+        void dumpJson(JsonWriter& aWriter)const;           ///< 実行結果を JSON 形式で出力します。
+
+        void writeReplay(int aStageIndex, ReplayWriter& aWriter)const;  ///< 記録をリプレイファイルに書き込みます。
+        void writeReplayResult(ReplayWriter& aWriter)const;             ///< 結果のみをリプレイファイルに書き込みます。
+        /// 記録をリプレイファイルから読み込みます。
+        bool readReplay(int aCharaCount, bool aHasDetail, ReplayReader& aReader);
 
     private:
         int mCurrentTurn;                                   ///< 現在のターン番号
@@ -40,12 +53,16 @@ namespace hpc {
         
         // 詳細な記録は、定数 DEBUG が定義されている場合にのみ表示されます。
 #ifdef DEBUG
-        TurnResult mTurns[Parameter::GameTurnPerStage + 1]; ///< 記録するターン。初期状態を含めるので1多くとる。
+        TurnResult* mTurns;                                 ///< 記録するターン。 TurnCountMax だけの要素を持つ。
         Field mField;                                       ///< フィールド情報
         LotusCollection mLotuses;                           ///< 蓮情報
         Vec2 mInitPositions[Parameter::CharaCountMax];      ///< 開始位置
 #endif
         bool mIsFailed;     ///< ステージ途中で失敗したか
+
+#ifdef DEBUG
+        int recordedTurnCount()const;
+#endif
     };
 }
 //------------------------------------------------------------------------------
@@ -0,0 +1,59 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCReplay.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCReplay.hpp"
+
+#include <cmath>
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// @return 4 文字のマジック。終端文字は含みません。
+    const char* Replay::Magic()
+    {
+        return "HPCR";
+    }
+
+    //------------------------------------------------------------------------------
+    /// 位置の成分を 1 / PosScale 単位の整数に丸めます。
+    ///
+    /// float を PosScale 倍した値は double で誤差なく表せるため、 printf の "%.3f" と
+    /// 同じく最近接偶数への丸めを行うことで、 JSON に出力される値と一致させます。
+    ///
+    /// @param[in] aValue 位置の成分。
+    ///
+    /// @return 量子化した値。
+    int Replay::QuantizePos(float aValue)
+    {
+        const double scaled = static_cast<double>(aValue) * PosScale;
+        const double floored = std::floor(scaled);
+        const double fraction = scaled - floored;
+        int result = static_cast<int>(floored);
+        if (0.5 < fraction || (fraction == 0.5 && (result & 1))) {
+            ++result;
+        }
+        return result;
+    }
+
+    //------------------------------------------------------------------------------
+    /// QuantizePos で量子化した値を位置の成分に戻します。
+    ///
+    /// @param[in] aValue 量子化した値。
+    ///
+    /// @return 位置の成分。
+    float Replay::DequantizePos(int aValue)
+    {
+        return static_cast<float>(static_cast<double>(aValue) / PosScale);
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
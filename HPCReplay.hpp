@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Replay クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// バイナリ形式のリプレイファイルの書式を定義します。
+    ///
+    /// リプレイファイルはリトルエンディアンで、次の順に並びます。
+    /// ステージの結果や合計得点は後ろに置かれるため、ゲームを実行しながら
+    /// 先頭から順に書き出すことができます。
+    ///
+    /// - ヘッダ (HeaderSize バイト固定)
+    ///   - マジック "HPCR" (4) / バージョン u16 / ヘッダサイズ u16
+    ///   - ステージ数 u16 / キャラ最大数 u8 / 必要周回数 u8
+    ///   - キャラ半径 f32 / 予約 u32
+    /// - 実行したステージごとのブロック
+    ///   - BlockStage u8 / ステージ番号 u8 / キャラ数 u8 / 詳細を含むか u8
+    ///   - 詳細を含む場合は以下が続きます。
+    ///     - フィールド矩形 f32 × 4 (left, right, bottom, top) / 流れ f32 × 2
+    ///     - 蓮の数 u8 / 蓮 f32 × 3 (x, y, 半径) × 蓮の数
+    ///     - 開始位置 f32 × 2 × キャラ数
+    ///     - ターンごとの行 × ターン数 / TurnEnd u8
+    ///   - 失敗したか u8 / 通過した蓮の数 u8 / ターン数 u16 / 順位 u8 × キャラ数
+    /// - 終端
+    ///   - BlockEnd u8 / 合計得点 u32
+    ///
+    /// ターンごとの行は、下位 4bit が加速回数か通過した蓮の数が前ターンから変化した
+    /// キャラのビットマスク、上位 4bit がステージの状態である u8 、
+    /// 変化したキャラの加速回数 u8 と通過した蓮の数 u8 、各キャラの位置の順に並びます。
+    /// 位置は 1 / PosScale 単位に量子化し、前ターンからの移動量の差分を
+    /// ジグザグ符号化した可変長整数で x, y の順に格納します。
+    /// 量子化の誤差は JSON 出力の精度 (小数点以下 3 桁) に収まります。
+    class Replay
+    {
+    public:
+        static const int Version = 2;           ///< 書式のバージョン
+        static const int HeaderSize = 20;       ///< ヘッダのバイト数
+        static const int PosScale = 1000;       ///< 位置を量子化する際の倍率
+        static const int BlockEnd = 0;          ///< 終端を表すブロックの種類
+        static const int BlockStage = 1;        ///< ステージを表すブロックの種類
+        static const int TurnEnd = 0xFF;        ///< ターンごとの行の終わりを表す値
+
+        static const char* Magic();             ///< ファイル先頭のマジックを返します。
+        static int QuantizePos(float aValue);   ///< 位置の成分を量子化します。
+        static float DequantizePos(int aValue); ///< 量子化された位置の成分を戻します。
+
+    private:
+        Replay();
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
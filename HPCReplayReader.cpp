@@ -0,0 +1,325 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCReplayReader.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCReplayReader.hpp"
+
+#include <cstring>
+#include "HPCField.hpp"
+#include "HPCLotusCollection.hpp"
+#include "HPCMath.hpp"
+#include "HPCReplay.hpp"
+#include "HPCTurnResult.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 入力元を指定してインスタンスを生成します。
+    ///
+    /// @param[in] aFile バイナリモードで開かれた入力元。 0 を指定した場合は常に失敗します。
+    ReplayReader::ReplayReader(std::FILE* aFile)
+        : mFile(aFile)
+        , mBuffer()
+        , mBufferedSize(0)
+        , mReadPos(0)
+        , mIsValid(aFile != 0)
+        , mCharaCount(0)
+        , mPosX()
+        , mPosY()
+        , mDeltaX()
+        , mDeltaY()
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// ヘッダを読み込み、このプログラムで読み込める書式かどうかを確認します。
+    ///
+    /// @return 読み込める書式の場合は @c true を返します。
+    ///         異なるバージョンやステージ数のファイルは読み込めません。
+    bool ReplayReader::readHeader()
+    {
+        char magic[4] = {};
+        readBytes(magic, 4);
+        if (std::memcmp(magic, Replay::Magic(), 4) != 0
+            || readU16() != Replay::Version
+            || readU16() != Replay::HeaderSize
+            || readU16() != Parameter::GameStageCount
+            || readU8() != Parameter::CharaCountMax
+            ) {
+            mIsValid = false;
+            return false;
+        }
+        // 残りのヘッダは記録の復元には使わない
+        readU8();
+        readF32();
+        readU32();
+        return mIsValid;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return Replay::BlockStage か Replay::BlockEnd 。
+    ///         失敗した場合は Replay::BlockEnd を返します。
+    int ReplayReader::readBlockType()
+    {
+        const int type = readU8();
+        if (type != Replay::BlockStage) {
+            if (type != Replay::BlockEnd) {
+                mIsValid = false;
+            }
+            return Replay::BlockEnd;
+        }
+        return type;
+    }
+
+    //------------------------------------------------------------------------------
+    /// readBlockType が Replay::BlockStage を返した後に呼び、ステージのブロックを開始します。
+    ///
+    /// @param[out] aStageIndex ステージ番号。
+    /// @param[out] aCharaCount キャラ数。
+    /// @param[out] aHasDetail  フィールドや各ターンの情報を含むか。
+    ///                         @c true の場合は readStageDetail と readTurn を呼んでから
+    ///                         readStageEnd を呼びます。
+    void ReplayReader::readStageStart(int& aStageIndex, int& aCharaCount, bool& aHasDetail)
+    {
+        aStageIndex = readU8();
+        aCharaCount = readU8();
+        aHasDetail = readU8() != 0;
+        if (Parameter::GameStageCount <= aStageIndex || Parameter::CharaCountMax < aCharaCount) {
+            mIsValid = false;
+            aStageIndex = 0;
+            aCharaCount = 0;
+            aHasDetail = false;
+        }
+
+        mCharaCount = aCharaCount;
+        for (int index = 0; index < Parameter::CharaCountMax; ++index) {
+            mPosX[index] = 0;
+            mPosY[index] = 0;
+            mDeltaX[index] = 0;
+            mDeltaY[index] = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの開始時の状態を読み込みます。
+    ///
+    /// フィールドの大きさが正でない場合や、蓮の半径が正の有限値でない場合は
+    /// 失敗として扱い、以降は何も読み込みません。
+    ///
+    /// @param[out] aField         フィールド。
+    /// @param[out] aLotuses       蓮。
+    /// @param[out] aInitPositions 各キャラの開始位置。キャラ数だけの要素が必要です。
+    void ReplayReader::readStageDetail(Field& aField, LotusCollection& aLotuses, Vec2* aInitPositions)
+    {
+        Rectangle rect;
+        rect.left = readF32();
+        rect.right = readF32();
+        rect.bottom = readF32();
+        rect.top = readF32();
+        Vec2 flowVel;
+        flowVel.x = readF32();
+        flowVel.y = readF32();
+        if (!Math::IsValid(rect.left) || !Math::IsValid(rect.right)
+            || !Math::IsValid(rect.bottom) || !Math::IsValid(rect.top)
+            || !(rect.left < rect.right) || !(rect.bottom < rect.top)
+            || !Math::IsValid(flowVel.x) || !Math::IsValid(flowVel.y)
+            ) {
+            mIsValid = false;
+            return;
+        }
+        aField.setup(rect, flowVel);
+
+        aLotuses.reset();
+        const int lotusCount = readU8();
+        if (Parameter::LotusCountMax < lotusCount) {
+            mIsValid = false;
+            return;
+        }
+        for (int index = 0; index < lotusCount; ++index) {
+            Vec2 pos;
+            pos.x = readF32();
+            pos.y = readF32();
+            const float radius = readF32();
+            if (!Math::IsValid(pos.x) || !Math::IsValid(pos.y)
+                || !Math::IsValid(radius) || !(0.0f < radius)
+                ) {
+                mIsValid = false;
+                return;
+            }
+            aLotuses.setupAddLotus(pos, radius);
+        }
+        for (int index = 0; index < mCharaCount; ++index) {
+            aInitPositions[index].x = readF32();
+            aInitPositions[index].y = readF32();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 1 ターン分の行を読み込み、前ターンの結果に差分を適用します。
+    ///
+    /// @param[in,out] aResult 前ターンの結果。最初のターンでは初期状態の TurnResult を渡します。
+    ///
+    /// @return 行を読み込んだ場合は @c true を返します。
+    ///         ターンの行が終わった場合や失敗した場合は @c false を返します。
+    bool ReplayReader::readTurn(TurnResult& aResult)
+    {
+        const int maskAndState = readU8();
+        if (!mIsValid || maskAndState == Replay::TurnEnd) {
+            return false;
+        }
+        const int state = maskAndState >> 4;
+        if (StageState_TERM < state) {
+            mIsValid = false;
+            return false;
+        }
+        aResult.state = static_cast<StageState>(state);
+        for (int index = 0; index < mCharaCount; ++index) {
+            if (maskAndState & (1 << index)) {
+                aResult.charas[index].accelCount = readU8();
+                aResult.charas[index].passedLotusCount = readU8();
+            }
+        }
+        for (int index = 0; index < mCharaCount; ++index) {
+            mDeltaX[index] += readVarInt();
+            mDeltaY[index] += readVarInt();
+            mPosX[index] += mDeltaX[index];
+            mPosY[index] += mDeltaY[index];
+            aResult.charas[index].pos.x = Replay::DequantizePos(mPosX[index]);
+            aResult.charas[index].pos.y = Replay::DequantizePos(mPosY[index]);
+        }
+        return mIsValid;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの結果を読み込み、ステージのブロックを終えます。
+    ///
+    /// @param[out] aIsFailed         ステージ途中で失敗したか。
+    /// @param[out] aPassedLotusCount プレイヤーが通過した蓮の数。
+    /// @param[out] aTurnCount        記録されたターン数。
+    /// @param[out] aRanks            各キャラの順位。キャラ数だけの要素が必要です。
+    void ReplayReader::readStageEnd(bool& aIsFailed, int& aPassedLotusCount, int& aTurnCount, int* aRanks)
+    {
+        aIsFailed = readU8() != 0;
+        aPassedLotusCount = readU8();
+        aTurnCount = readU16();
+        for (int index = 0; index < mCharaCount; ++index) {
+            aRanks[index] = readU8();
+        }
+        if (Parameter::GameTurnPerStage + 1 < aTurnCount) {
+            mIsValid = false;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// readBlockType が Replay::BlockEnd を返した後に呼び、終端を読み込みます。
+    ///
+    /// @return 合計得点。
+    int ReplayReader::readEnd()
+    {
+        return static_cast<int>(readU32());
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[out] aData 読み込んだデータの書き込み先。
+    /// @param[in]  aSize 読み込むバイト数。
+    void ReplayReader::readBytes(void* aData, int aSize)
+    {
+        unsigned char* data = static_cast<unsigned char*>(aData);
+        for (int index = 0; index < aSize; ++index) {
+            data[index] = static_cast<unsigned char>(get());
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 読み込んだ値。
+    int ReplayReader::readU8()
+    {
+        return get();
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 読み込んだ値。
+    int ReplayReader::readU16()
+    {
+        const int low = get();
+        const int high = get();
+        return low | (high << 8);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 読み込んだ値。
+    uint ReplayReader::readU32()
+    {
+        uint value = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            value |= static_cast<uint>(get()) << shift;
+        }
+        return value;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 読み込んだ値。書き込んだ値とビット単位で一致します。
+    float ReplayReader::readF32()
+    {
+        const uint bits = readU32();
+        float value = 0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ReplayWriter::writeVarInt で書き込んだ値を読み込みます。
+    ///
+    /// @return 読み込んだ値。
+    int ReplayReader::readVarInt()
+    {
+        uint bits = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            const int byte = get();
+            bits |= static_cast<uint>(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return static_cast<int>(bits >> 1) ^ -static_cast<int>(bits & 1);
+            }
+        }
+        // 5 バイトを超える値は書き込まれないため、壊れたデータとみなす
+        mIsValid = false;
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return これまでの読み込みがすべて成功していれば @c true を返します。
+    bool ReplayReader::isValid()const
+    {
+        return mIsValid;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 1 バイトを読み込みます。必要に応じてファイルからバッファへ読み込みます。
+    ///
+    /// @return 読み込んだ値。失敗した場合は 0 を返します。
+    int ReplayReader::get()
+    {
+        if (!mIsValid) {
+            return 0;
+        }
+        if (mReadPos == mBufferedSize) {
+            mBufferedSize = static_cast<int>(std::fread(mBuffer, 1, BufferSize, mFile));
+            mReadPos = 0;
+            if (mBufferedSize == 0) {
+                mIsValid = false;
+                return 0;
+            }
+        }
+        return mBuffer[mReadPos++];
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
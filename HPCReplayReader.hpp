@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    ReplayReader クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+#include "HPCParameter.hpp"
+#include "HPCTypes.hpp"
+
+namespace hpc {
+
+    class Field;
+    class LotusCollection;
+    class Vec2;
+    struct TurnResult;
+
+    //------------------------------------------------------------------------------
+    /// リプレイファイルを読み込みます。
+    ///
+    /// ReplayWriter で書き込んだ値を、同じ順に読み出します。
+    /// ファイルの終端を超えて読もうとすると isValid が @c false を返すようになり、
+    /// 以降の読み込みはすべて 0 を返します。
+    /// 書式に合わないデータを読んだ場合も同様です。
+    class ReplayReader
+    {
+    public:
+        explicit ReplayReader(std::FILE* aFile);
+
+        /// @name ブロックの読み込み
+        //@{
+        bool readHeader();                              ///< ヘッダを読み込み、書式を確認します。
+        int readBlockType();                            ///< 次のブロックの種類を読み込みます。
+        /// ステージのブロックの開始部分を読み込みます。
+        void readStageStart(int& aStageIndex, int& aCharaCount, bool& aHasDetail);
+        /// ステージの詳細を読み込みます。
+        void readStageDetail(Field& aField, LotusCollection& aLotuses, Vec2* aInitPositions);
+        bool readTurn(TurnResult& aResult);             ///< 1 ターン分の行を読み込みます。
+        /// ステージの結果を読み込み、ブロックを終えます。
+        void readStageEnd(bool& aIsFailed, int& aPassedLotusCount, int& aTurnCount, int* aRanks);
+        int readEnd();                                  ///< 終端を読み込みます。
+        //@}
+
+        /// @name 値の読み込み
+        //@{
+        void readBytes(void* aData, int aSize);         ///< バイト列をそのまま読み込みます。
+        int readU8();                                   ///< 符号なし 8bit 整数を読み込みます。
+        int readU16();                                  ///< 符号なし 16bit 整数を読み込みます。
+        uint readU32();                                 ///< 符号なし 32bit 整数を読み込みます。
+        float readF32();                                ///< 浮動小数を読み込みます。
+        int readVarInt();                               ///< 可変長の符号付き整数を読み込みます。
+        //@}
+
+        bool isValid()const;                            ///< これまでの読み込みが成功しているかを返します。
+
+    private:
+        static const int BufferSize = 64 * 1024;        ///< バッファのバイト数
+
+        std::FILE* mFile;                               ///< 入力元
+        unsigned char mBuffer[BufferSize];              ///< 読み込んだデータ
+        int mBufferedSize;                              ///< バッファ内の有効なバイト数
+        int mReadPos;                                   ///< バッファ内の次に読む位置
+        bool mIsValid;                                  ///< 読み込みに成功しているか
+        int mCharaCount;                                ///< 読み込み中のステージのキャラ数
+        int mPosX[Parameter::CharaCountMax];            ///< 前ターンの量子化した x 座標
+        int mPosY[Parameter::CharaCountMax];            ///< 前ターンの量子化した y 座標
+        int mDeltaX[Parameter::CharaCountMax];          ///< 前ターンの x 方向の移動量
+        int mDeltaY[Parameter::CharaCountMax];          ///< 前ターンの y 方向の移動量
+
+        int get();
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,318 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCReplayWriter.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCReplayWriter.hpp"
+
+#include <cstring>
+#include "HPCCommon.hpp"
+#include "HPCField.hpp"
+#include "HPCLotusCollection.hpp"
+#include "HPCReplay.hpp"
+#include "HPCTurnResult.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 出力先を指定してインスタンスを生成します。
+    ///
+    /// @param[in] aFile バイナリモードで開かれた出力先。 0 を指定した場合は常に失敗します。
+    ReplayWriter::ReplayWriter(std::FILE* aFile)
+        : mFile(aFile)
+        , mBuffer()
+        , mBufferedSize(0)
+        , mWrittenSize(0)
+        , mIsValid(aFile != 0)
+        , mCharaCount(0)
+        , mHasDetail(false)
+        , mPrevAccelCounts()
+        , mPrevPassedCounts()
+        , mPrevPosX()
+        , mPrevPosY()
+        , mPrevDeltaX()
+        , mPrevDeltaY()
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 出力されていないデータを出力してからインスタンスを破棄します。
+    /// ファイルは閉じません。
+    ReplayWriter::~ReplayWriter()
+    {
+        flush();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 出力されていないデータを出力してから、出力先を設定し直します。
+    /// 書き込んだ総バイト数や失敗の状態も初期化されます。
+    ///
+    /// @param[in] aFile バイナリモードで開かれた出力先。 0 を指定した場合は常に失敗します。
+    void ReplayWriter::setup(std::FILE* aFile)
+    {
+        flush();
+        mFile = aFile;
+        mWrittenSize = 0;
+        mIsValid = (aFile != 0);
+        mCharaCount = 0;
+        mHasDetail = false;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ゲーム全体の情報を表すヘッダを書き込みます。
+    void ReplayWriter::writeHeader()
+    {
+        writeBytes(Replay::Magic(), 4);
+        writeU16(Replay::Version);
+        writeU16(Replay::HeaderSize);
+        writeU16(Parameter::GameStageCount);
+        writeU8(Parameter::CharaCountMax);
+        writeU8(Parameter::StageRoundCount);
+        writeF32(Parameter::CharaRadius());
+        writeU32(0);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージのブロックを開始します。
+    ///
+    /// aHasDetail が @c true の場合は、続けて writeStageDetail と各ターンの writeTurn を
+    /// 呼んでから writeStageEnd を呼びます。
+    /// @c false の場合は、すぐに writeStageEnd を呼びます。
+    ///
+    /// @param[in] aStageIndex ステージ番号。
+    /// @param[in] aCharaCount キャラ数。
+    /// @param[in] aHasDetail  フィールドや各ターンの情報を含むか。
+    void ReplayWriter::writeStageStart(int aStageIndex, int aCharaCount, bool aHasDetail)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        HPC_RANGE_ASSERT_MIN_MAX_I(aCharaCount, 0, Parameter::CharaCountMax);
+
+        writeU8(Replay::BlockStage);
+        writeU8(aStageIndex);
+        writeU8(aCharaCount);
+        writeU8(aHasDetail ? 1 : 0);
+
+        mCharaCount = aCharaCount;
+        mHasDetail = aHasDetail;
+        for (int index = 0; index < Parameter::CharaCountMax; ++index) {
+            mPrevAccelCounts[index] = 0;
+            mPrevPassedCounts[index] = 0;
+            mPrevPosX[index] = 0;
+            mPrevPosY[index] = 0;
+            mPrevDeltaX[index] = 0;
+            mPrevDeltaY[index] = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの開始時の状態を書き込みます。
+    /// 浮動小数はビット列のまま書き込むため、読み込んだ値は元の値と一致します。
+    ///
+    /// @param[in] aField         フィールド。
+    /// @param[in] aLotuses       蓮。
+    /// @param[in] aInitPositions 各キャラの開始位置。キャラ数だけの要素が必要です。
+    void ReplayWriter::writeStageDetail(const Field& aField, const LotusCollection& aLotuses, const Vec2* aInitPositions)
+    {
+        HPC_ASSERT(mHasDetail);
+
+        writeF32(aField.rect().left);
+        writeF32(aField.rect().right);
+        writeF32(aField.rect().bottom);
+        writeF32(aField.rect().top);
+        writeF32(aField.flowVel().x);
+        writeF32(aField.flowVel().y);
+
+        writeU8(aLotuses.count());
+        for (int index = 0; index < aLotuses.count(); ++index) {
+            writeF32(aLotuses[index].pos().x);
+            writeF32(aLotuses[index].pos().y);
+            writeF32(aLotuses[index].radius());
+        }
+        for (int index = 0; index < mCharaCount; ++index) {
+            writeF32(aInitPositions[index].x);
+            writeF32(aInitPositions[index].y);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 1 ターン分の結果を、前ターンからの差分として書き込みます。
+    ///
+    /// @param[in] aResult ターンの実行結果。
+    void ReplayWriter::writeTurn(const TurnResult& aResult)
+    {
+        HPC_ASSERT(mHasDetail);
+
+        int mask = 0;
+        for (int index = 0; index < mCharaCount; ++index) {
+            if (aResult.charas[index].accelCount != mPrevAccelCounts[index]
+                || aResult.charas[index].passedLotusCount != mPrevPassedCounts[index]
+                ) {
+                mask |= 1 << index;
+            }
+        }
+        writeU8(mask | (aResult.state << 4));
+        for (int index = 0; index < mCharaCount; ++index) {
+            if (mask & (1 << index)) {
+                writeU8(aResult.charas[index].accelCount);
+                writeU8(aResult.charas[index].passedLotusCount);
+                mPrevAccelCounts[index] = aResult.charas[index].accelCount;
+                mPrevPassedCounts[index] = aResult.charas[index].passedLotusCount;
+            }
+        }
+        for (int index = 0; index < mCharaCount; ++index) {
+            const int posX = Replay::QuantizePos(aResult.charas[index].pos.x);
+            const int posY = Replay::QuantizePos(aResult.charas[index].pos.y);
+            const int deltaX = posX - mPrevPosX[index];
+            const int deltaY = posY - mPrevPosY[index];
+            writeVarInt(deltaX - mPrevDeltaX[index]);
+            writeVarInt(deltaY - mPrevDeltaY[index]);
+            mPrevPosX[index] = posX;
+            mPrevPosY[index] = posY;
+            mPrevDeltaX[index] = deltaX;
+            mPrevDeltaY[index] = deltaY;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの結果を書き込み、ステージのブロックを終えます。
+    ///
+    /// @param[in] aIsFailed         ステージ途中で失敗したか。
+    /// @param[in] aPassedLotusCount プレイヤーが通過した蓮の数。
+    /// @param[in] aTurnCount        記録したターン数。
+    /// @param[in] aRanks            各キャラの順位。キャラ数だけの要素が必要です。
+    void ReplayWriter::writeStageEnd(bool aIsFailed, int aPassedLotusCount, int aTurnCount, const int* aRanks)
+    {
+        if (mHasDetail) {
+            writeU8(Replay::TurnEnd);
+        }
+        writeU8(aIsFailed ? 1 : 0);
+        writeU8(aPassedLotusCount);
+        writeU16(aTurnCount);
+        for (int index = 0; index < mCharaCount; ++index) {
+            writeU8(aRanks[index]);
+        }
+        mHasDetail = false;
+    }
+
+    //------------------------------------------------------------------------------
+    /// リプレイファイルの終端を書き込みます。
+    ///
+    /// @param[in] aScore 合計得点。
+    void ReplayWriter::writeEnd(int aScore)
+    {
+        writeU8(Replay::BlockEnd);
+        writeU32(static_cast<uint>(aScore));
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aData 書き込むデータの先頭。
+    /// @param[in] aSize 書き込むバイト数。
+    void ReplayWriter::writeBytes(const void* aData, int aSize)
+    {
+        const unsigned char* data = static_cast<const unsigned char*>(aData);
+        for (int index = 0; index < aSize; ++index) {
+            put(data[index]);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aValue 書き込む値。 [0, 0xFF] の範囲である必要があります。
+    void ReplayWriter::writeU8(int aValue)
+    {
+        HPC_RANGE_ASSERT_MIN_MAX_I(aValue, 0, 0xFF);
+        put(aValue);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aValue 書き込む値。 [0, 0xFFFF] の範囲である必要があります。
+    void ReplayWriter::writeU16(int aValue)
+    {
+        HPC_RANGE_ASSERT_MIN_MAX_I(aValue, 0, 0xFFFF);
+        put(aValue & 0xFF);
+        put((aValue >> 8) & 0xFF);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aValue 書き込む値。
+    void ReplayWriter::writeU32(uint aValue)
+    {
+        put(aValue & 0xFF);
+        put((aValue >> 8) & 0xFF);
+        put((aValue >> 16) & 0xFF);
+        put((aValue >> 24) & 0xFF);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 浮動小数を IEEE 754 のビット列のまま書き込むため、読み込んだ値は元の値と一致します。
+    ///
+    /// @param[in] aValue 書き込む値。
+    void ReplayWriter::writeF32(float aValue)
+    {
+        uint bits = 0;
+        std::memcpy(&bits, &aValue, sizeof(bits));
+        writeU32(bits);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 値をジグザグ符号化し、下位から 7bit ずつ書き込みます。
+    /// 絶対値が 64 未満なら 1 バイト、8192 未満なら 2 バイトになります。
+    ///
+    /// @param[in] aValue 書き込む値。
+    void ReplayWriter::writeVarInt(int aValue)
+    {
+        uint bits = (static_cast<uint>(aValue) << 1) ^ static_cast<uint>(aValue >> 31);
+        while (0x80 <= bits) {
+            put(static_cast<int>(bits & 0x7F) | 0x80);
+            bits >>= 7;
+        }
+        put(static_cast<int>(bits));
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return これまでの書き込みがすべて成功していれば @c true を返します。
+    bool ReplayWriter::flush()
+    {
+        if (mIsValid && 0 < mBufferedSize) {
+            if (std::fwrite(mBuffer, 1, mBufferedSize, mFile) != static_cast<size_t>(mBufferedSize)) {
+                mIsValid = false;
+            }
+        }
+        mBufferedSize = 0;
+        return mIsValid;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return これまでの書き込みがすべて成功していれば @c true を返します。
+    bool ReplayWriter::isValid()const
+    {
+        return mIsValid;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 書き込んだ総バイト数。バッファ内の出力待ちのデータも含みます。
+    int ReplayWriter::writtenSize()const
+    {
+        return mWrittenSize;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 1 バイトをバッファに追加します。
+    void ReplayWriter::put(int aByte)
+    {
+        if (mBufferedSize == BufferSize) {
+            flush();
+        }
+        mBuffer[mBufferedSize] = static_cast<unsigned char>(aByte);
+        ++mBufferedSize;
+        ++mWrittenSize;
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
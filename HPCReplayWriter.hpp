@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    ReplayWriter クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+#include "HPCParameter.hpp"
+#include "HPCTypes.hpp"
+
+namespace hpc {
+
+    class Field;
+    class LotusCollection;
+    class Vec2;
+    struct TurnResult;
+
+    //------------------------------------------------------------------------------
+    /// リプレイファイルを書き込みます。
+    ///
+    /// 書き込む値はバッファに溜め、バッファが一杯になるか flush を呼んだときに
+    /// まとめてファイルへ出力します。
+    /// ブロック単位の関数は Replay クラスで説明している書式で書き込みます。
+    /// 書き込みに失敗すると isValid が @c false を返すようになり、以降の書き込みは無視されます。
+    class ReplayWriter
+    {
+    public:
+        explicit ReplayWriter(std::FILE* aFile);
+        ~ReplayWriter();
+
+        void setup(std::FILE* aFile);                   ///< 出力先を設定し直します。
+
+        /// @name ブロックの書き込み
+        //@{
+        void writeHeader();                             ///< ヘッダを書き込みます。
+        /// ステージのブロックを開始します。
+        void writeStageStart(int aStageIndex, int aCharaCount, bool aHasDetail);
+        /// ステージの詳細を書き込みます。
+        void writeStageDetail(const Field& aField, const LotusCollection& aLotuses, const Vec2* aInitPositions);
+        void writeTurn(const TurnResult& aResult);      ///< 1 ターン分の行を書き込みます。
+        /// ステージの結果を書き込み、ブロックを終えます。
+        void writeStageEnd(bool aIsFailed, int aPassedLotusCount, int aTurnCount, const int* aRanks);
+        void writeEnd(int aScore);                      ///< 終端を書き込みます。
+        //@}
+
+        /// @name 値の書き込み
+        //@{
+        void writeBytes(const void* aData, int aSize);  ///< バイト列をそのまま書き込みます。
+        void writeU8(int aValue);                       ///< 符号なし 8bit 整数を書き込みます。
+        void writeU16(int aValue);                      ///< 符号なし 16bit 整数を書き込みます。
+        void writeU32(uint aValue);                     ///< 符号なし 32bit 整数を書き込みます。
+        void writeF32(float aValue);                    ///< 浮動小数をビット列のまま書き込みます。
+        void writeVarInt(int aValue);                   ///< 符号付き整数を可変長で書き込みます。
+        //@}
+
+        bool flush();                                   ///< バッファの内容をファイルへ出力します。
+        bool isValid()const;                            ///< これまでの書き込みが成功しているかを返します。
+        int writtenSize()const;                         ///< 書き込んだ総バイト数を返します。
+
+    private:
+        static const int BufferSize = 64 * 1024;        ///< バッファのバイト数
+
+        std::FILE* mFile;                               ///< 出力先
+        unsigned char mBuffer[BufferSize];              ///< 出力待ちのデータ
+        int mBufferedSize;                              ///< 出力待ちのバイト数
+        int mWrittenSize;                               ///< 書き込んだ総バイト数
+        bool mIsValid;                                  ///< 書き込みに成功しているか
+        int mCharaCount;                                ///< 書き込み中のステージのキャラ数
+        bool mHasDetail;                                ///< 書き込み中のステージが詳細を含むか
+        int mPrevAccelCounts[Parameter::CharaCountMax]; ///< 前ターンの加速回数
+        int mPrevPassedCounts[Parameter::CharaCountMax];///< 前ターンの通過した蓮の数
+        int mPrevPosX[Parameter::CharaCountMax];        ///< 前ターンの量子化した x 座標
+        int mPrevPosY[Parameter::CharaCountMax];        ///< 前ターンの量子化した y 座標
+        int mPrevDeltaX[Parameter::CharaCountMax];      ///< 前ターンの x 方向の移動量
+        int mPrevDeltaY[Parameter::CharaCountMax];      ///< 前ターンの y 方向の移動量
+
+        void put(int aByte);
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
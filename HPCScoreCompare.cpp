@@ -0,0 +1,416 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCScoreCompare.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCScoreCompare.hpp"
+
+#include <cmath>
+#include <cstring>
+#include "HPCCommon.hpp"
+
+namespace {
+    using namespace hpc;
+
+    /// 有意とみなす有意水準 (両側) 。ステージの検定では、全ステージでの有意水準です。
+    const double SignificanceLevel = 0.05;
+    /// 不完全ベータ関数の連分数を打ち切る回数
+    const int BetaFractionCountMax = 200;
+    /// 不完全ベータ関数の連分数を収束したとみなす相対誤差
+    const double BetaFractionEpsilon = 1.0e-12;
+    /// 連分数の計算で 0 で割らないように使う小さな値
+    const double BetaFractionTiny = 1.0e-300;
+
+    //------------------------------------------------------------------------------
+    /// 差の平均が 0 からどれだけ離れているかを t 値で求めます。
+    ///
+    /// @param[in] aDelta 得点の差の統計。
+    ///
+    /// @return t 値。標本が2つ未満か、差にばらつきがない場合は 0 を返します。
+    double TValue(const Statistics& aDelta)
+    {
+        const double stddev = aDelta.stddev();
+        if (aDelta.count() < 2 || stddev == 0) {
+            return 0;
+        }
+        return aDelta.mean() / (stddev / std::sqrt(static_cast<double>(aDelta.count())));
+    }
+
+    //------------------------------------------------------------------------------
+    /// ガンマ関数の自然対数を Lanczos 近似 (g = 7) で求めます。
+    ///
+    /// @param[in] aX 正の値。
+    double LogGamma(double aX)
+    {
+        static const double Coefs[9] = {
+            0.99999999999980993,
+            676.5203681218851,
+            -1259.1392167224028,
+            771.32342877765313,
+            -176.61502916214059,
+            12.507343278686905,
+            -0.13857109526572012,
+            9.9843695780195716e-6,
+            1.5056327351493116e-7,
+        };
+        const double x = aX - 1.0;
+        double sum = Coefs[0];
+        for (int index = 1; index < 9; ++index) {
+            sum += Coefs[index] / (x + index);
+        }
+        const double t = x + 7.5;
+        return 0.5 * std::log(2.0 * 3.14159265358979323846) + (x + 0.5) * std::log(t) - t + std::log(sum);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 不完全ベータ関数の連分数を、修正 Lentz 法で求めます。
+    /// aX < (aA + 1) / (aA + aB + 2) の範囲で速く収束します。
+    double BetaFraction(double aA, double aB, double aX)
+    {
+        double c = 1.0;
+        double d = 1.0 - (aA + aB) * aX / (aA + 1.0);
+        d = 1.0 / (std::fabs(d) < BetaFractionTiny ? BetaFractionTiny : d);
+        double result = d;
+        for (int m = 1; m <= BetaFractionCountMax; ++m) {
+            for (int step = 0; step < 2; ++step) {
+                const double numerator = (step == 0)
+                    ? m * (aB - m) * aX / ((aA + 2 * m - 1) * (aA + 2 * m))
+                    : -(aA + m) * (aA + aB + m) * aX / ((aA + 2 * m) * (aA + 2 * m + 1));
+                d = 1.0 + numerator * d;
+                d = 1.0 / (std::fabs(d) < BetaFractionTiny ? BetaFractionTiny : d);
+                c = 1.0 + numerator / c;
+                c = std::fabs(c) < BetaFractionTiny ? BetaFractionTiny : c;
+                const double delta = c * d;
+                result *= delta;
+                if (step == 1 && std::fabs(delta - 1.0) < BetaFractionEpsilon) {
+                    return result;
+                }
+            }
+        }
+        return result;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 正則化された不完全ベータ関数 I_x(a, b) を求めます。
+    double IncompleteBeta(double aA, double aB, double aX)
+    {
+        if (aX <= 0.0) {
+            return 0.0;
+        }
+        if (1.0 <= aX) {
+            return 1.0;
+        }
+        const double front = std::exp(
+            LogGamma(aA + aB) - LogGamma(aA) - LogGamma(aB)
+            + aA * std::log(aX) + aB * std::log(1.0 - aX)
+            );
+        if (aX < (aA + 1.0) / (aA + aB + 2.0)) {
+            return front * BetaFraction(aA, aB, aX) / aA;
+        }
+        return 1.0 - front * BetaFraction(aB, aA, 1.0 - aX) / aB;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 差の平均が 0 であるという仮説の両側 p 値を、自由度 n - 1 の t 分布で求めます。
+    ///
+    /// @param[in] aDelta 得点の差の統計。
+    ///
+    /// @return p 値。標本が2つ未満で判定できない場合は 1 を返します。
+    ///         差にばらつきがない場合は、差があれば 0 、なければ 1 を返します。
+    double PValue(const Statistics& aDelta)
+    {
+        if (aDelta.count() < 2) {
+            return 1.0;
+        }
+        if (aDelta.stddev() == 0) {
+            // 毎回同じ差なら、差がある限り確実に変化している
+            return aDelta.mean() == 0 ? 1.0 : 0.0;
+        }
+        const double t = TValue(aDelta);
+        const double df = aDelta.count() - 1;
+        return IncompleteBeta(0.5 * df, 0.5, df / (df + t * t));
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aDelta         得点の差の統計。
+    /// @param[in] aIsSignificant 有意な差があるか。
+    ///
+    /// @return 表示する判定の文字列。
+    const char* Verdict(const Statistics& aDelta, bool aIsSignificant)
+    {
+        if (!aIsSignificant) {
+            return "";
+        }
+        return aDelta.mean() < 0 ? "WORSE" : "better";
+    }
+
+    //------------------------------------------------------------------------------
+    /// 比較結果を 1 行表示します。
+    void PrintRow(
+        const char* aLabel
+        , const Statistics& aBase
+        , const Statistics& aCand
+        , const Statistics& aDelta
+        , double aPValue
+        , bool aIsSignificant
+        )
+    {
+        HPC_PRINT("%8s %14.3f %14.3f %12.3f %10.2f %10.4f  %s\n"
+            , aLabel
+            , aBase.mean()
+            , aCand.mean()
+            , aDelta.mean()
+            , TValue(aDelta)
+            , aPValue
+            , Verdict(aDelta, aIsSignificant)
+            );
+    }
+}
+
+namespace hpc {
+
+    const char* const ScoreCompare::FileHeader = "hpc2014-scores";
+
+    //------------------------------------------------------------------------------
+    /// 比較結果を持たない状態でインスタンスを生成します。
+    ScoreCompare::ScoreCompare()
+        : mStageBegin(0)
+        , mStageEnd(0)
+        , mBaseStats()
+        , mCandStats()
+        , mDeltaStats()
+        , mBaseTotal()
+        , mCandTotal()
+        , mDeltaTotal()
+        , mStagePValues()
+        , mIsStageSignificant()
+        , mTotalPValue(1.0)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 2つの得点ファイルを先頭から同時に読み、同じシードの得点の差を集計します。
+    ///
+    /// @param[in] aBasePath      基準にする得点ファイル。
+    /// @param[in] aCandidatePath 比較する得点ファイル。
+    ///
+    /// @return 読み込みに成功した場合は @c true を返します。
+    ///         失敗した場合は理由を表示して @c false を返します。
+    bool ScoreCompare::run(const char* aBasePath, const char* aCandidatePath)
+    {
+        reset();
+
+        std::FILE* files[2] = {
+            std::fopen(aBasePath, "r"),
+            std::fopen(aCandidatePath, "r"),
+        };
+        const char* paths[2] = { aBasePath, aCandidatePath };
+        bool isSucceeded = true;
+        int stageBegins[2] = {};
+        int stageEnds[2] = {};
+        for (int index = 0; index < 2 && isSucceeded; ++index) {
+            if (!files[index]) {
+                HPC_PRINT("Failed to open %s.\n", paths[index]);
+                isSucceeded = false;
+            } else {
+                isSucceeded = readHeader(files[index], paths[index], stageBegins[index], stageEnds[index]);
+            }
+        }
+        if (isSucceeded && (stageBegins[0] != stageBegins[1] || stageEnds[0] != stageEnds[1])) {
+            HPC_PRINT("The stage ranges are different.\n");
+            isSucceeded = false;
+        }
+        mStageBegin = stageBegins[0];
+        mStageEnd = stageEnds[0];
+
+        while (isSucceeded) {
+            int seeds[2] = {};
+            const int baseCount = std::fscanf(files[0], " seed %d", &seeds[0]);
+            const int candCount = std::fscanf(files[1], " seed %d", &seeds[1]);
+            if (baseCount != 1 || candCount != 1) {
+                if (baseCount != candCount) {
+                    HPC_PRINT("The seed lists are different.\n");
+                    isSucceeded = false;
+                }
+                break;
+            }
+            if (seeds[0] != seeds[1]) {
+                HPC_PRINT("The seed lists are different. (%d, %d)\n", seeds[0], seeds[1]);
+                isSucceeded = false;
+                break;
+            }
+
+            // 壊れた行の得点は集計しないように、1行分を読み終えてから加える
+            double scores[2][Parameter::GameStageCount] = {};
+            for (int stage = mStageBegin; stage < mStageEnd && isSucceeded; ++stage) {
+                for (int index = 0; index < 2 && isSucceeded; ++index) {
+                    if (std::fscanf(files[index], "%lf", &scores[index][stage]) != 1) {
+                        HPC_PRINT("%s: Stage %d of seed %d is broken.\n", paths[index], stage, seeds[0]);
+                        isSucceeded = false;
+                    }
+                }
+            }
+            if (!isSucceeded) {
+                break;
+            }
+
+            double baseTotal = 0;
+            double candTotal = 0;
+            for (int stage = mStageBegin; stage < mStageEnd; ++stage) {
+                mBaseStats[stage].add(scores[0][stage]);
+                mCandStats[stage].add(scores[1][stage]);
+                mDeltaStats[stage].add(scores[1][stage] - scores[0][stage]);
+                baseTotal += scores[0][stage];
+                candTotal += scores[1][stage];
+            }
+            // Record::score と同じく、合計してから整数に丸める
+            mBaseTotal.add(static_cast<int>(baseTotal));
+            mCandTotal.add(static_cast<int>(candTotal));
+            mDeltaTotal.add(static_cast<int>(candTotal) - static_cast<int>(baseTotal));
+        }
+        if (isSucceeded && mDeltaTotal.count() == 0) {
+            HPC_PRINT("No seeds to compare.\n");
+            isSucceeded = false;
+        }
+
+        for (int index = 0; index < 2; ++index) {
+            if (files[index]) {
+                std::fclose(files[index]);
+            }
+        }
+        if (isSucceeded) {
+            judge();
+        }
+        return isSucceeded;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各ステージと合計得点について、基準と比較対象の平均、差の平均、 t 値、 p 値を表示します。
+    /// 有意に下がったものには WORSE 、上がったものには better を付けます。
+    /// ステージの p 値は補正前の値で、判定は Holm 法で補正した結果です。
+    void ScoreCompare::outputResult()const
+    {
+        HPC_PRINT("%8s:%8d\n", "Seeds", mDeltaTotal.count());
+        HPC_PRINT("%8s:%8d - %d\n", "Stages", mStageBegin, mStageEnd - 1);
+        HPC_PRINT("\n%8s %14s %14s %12s %10s %10s\n", "Stage", "Base", "Candidate", "Delta", "t", "p");
+        char label[16];
+        for (int stage = mStageBegin; stage < mStageEnd; ++stage) {
+            std::sprintf(label, "%d", stage);
+            PrintRow(label, mBaseStats[stage], mCandStats[stage], mDeltaStats[stage]
+                , mStagePValues[stage], mIsStageSignificant[stage]);
+        }
+        HPC_PRINT("\n");
+        PrintRow("Score", mBaseTotal, mCandTotal, mDeltaTotal
+            , mTotalPValue, mTotalPValue < SignificanceLevel);
+        HPC_PRINT("%s\n", hasRegression() ? "Regression detected." : "No regression.");
+    }
+
+    //------------------------------------------------------------------------------
+    /// シードが1つしかない場合は判定できないので、常に @c false になります。
+    ///
+    /// @return 合計得点、またはいずれかのステージの得点が有意に下がった場合は @c true を返します。
+    bool ScoreCompare::hasRegression()const
+    {
+        if (mTotalPValue < SignificanceLevel && mDeltaTotal.mean() < 0) {
+            return true;
+        }
+        for (int stage = mStageBegin; stage < mStageEnd; ++stage) {
+            if (mIsStageSignificant[stage] && mDeltaStats[stage].mean() < 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------------
+    void ScoreCompare::reset()
+    {
+        mStageBegin = 0;
+        mStageEnd = 0;
+        for (int stage = 0; stage < Parameter::GameStageCount; ++stage) {
+            mBaseStats[stage].reset();
+            mCandStats[stage].reset();
+            mDeltaStats[stage].reset();
+        }
+        mBaseTotal.reset();
+        mCandTotal.reset();
+        mDeltaTotal.reset();
+        for (int stage = 0; stage < Parameter::GameStageCount; ++stage) {
+            mStagePValues[stage] = 1.0;
+            mIsStageSignificant[stage] = false;
+        }
+        mTotalPValue = 1.0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 集計した差から p 値を求め、各ステージの判定を Holm 法で補正します。
+    ///
+    /// Holm 法では p 値の小さい順に、 k 番目 (0 から数える) の検定を
+    /// 有意水準 / (ステージ数 - k) と比べ、初めて有意でなくなったところで打ち切ります。
+    void ScoreCompare::judge()
+    {
+        mTotalPValue = PValue(mDeltaTotal);
+
+        int order[Parameter::GameStageCount];
+        int count = 0;
+        for (int stage = mStageBegin; stage < mStageEnd; ++stage) {
+            mStagePValues[stage] = PValue(mDeltaStats[stage]);
+            mIsStageSignificant[stage] = false;
+            // p 値の小さい順に挿入する
+            int index = count;
+            while (0 < index && mStagePValues[stage] < mStagePValues[order[index - 1]]) {
+                order[index] = order[index - 1];
+                --index;
+            }
+            order[index] = stage;
+            ++count;
+        }
+        for (int rank = 0; rank < count; ++rank) {
+            const int stage = order[rank];
+            if (SignificanceLevel / (count - rank) <= mStagePValues[stage]) {
+                break;
+            }
+            mIsStageSignificant[stage] = true;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 得点ファイルの先頭の2行を読みます。
+    ///
+    /// @param[in]  aFile       得点ファイル。
+    /// @param[in]  aPath       エラーの表示に使うファイル名。
+    /// @param[out] aStageBegin 最初のステージ番号。
+    /// @param[out] aStageEnd   最後のステージ番号 + 1 。
+    ///
+    /// @return 正しい形式の場合は @c true を返します。
+    bool ScoreCompare::readHeader(std::FILE* aFile, const char* aPath, int& aStageBegin, int& aStageEnd)const
+    {
+        char header[32];
+        int version = 0;
+        if (std::fscanf(aFile, "%31s %d", header, &version) != 2
+            || std::strcmp(header, FileHeader) != 0
+            || version != FileVersion
+        ) {
+            HPC_PRINT("%s is not a score file.\n", aPath);
+            return false;
+        }
+        if (std::fscanf(aFile, " stages %d %d", &aStageBegin, &aStageEnd) != 2
+            || aStageBegin < 0
+            || aStageEnd <= aStageBegin
+            || Parameter::GameStageCount < aStageEnd
+        ) {
+            HPC_PRINT("%s has an invalid stage range.\n", aPath);
+            return false;
+        }
+        return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
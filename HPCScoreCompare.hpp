@@ -0,0 +1,67 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    ScoreCompare クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+#include "HPCParameter.hpp"
+#include "HPCStatistics.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// Batch が書き出した2つの得点ファイルを比べ、得点が下がったステージを調べます。
+    ///
+    /// 2つのファイルは同じシードの一覧と同じステージの範囲で実行したものである必要があります。
+    /// 同じシードの同じステージの得点の差を標本として、差の平均が 0 と有意に
+    /// 異なるかを、自由度 (シード数 - 1) の t 分布で判定します (対応のある t 検定) 。
+    /// 各ステージの判定は多数の検定を同時に行うことになるので、
+    /// Holm 法で補正し、全ステージを合わせた有意水準を保ちます。
+    ///
+    /// 得点ファイルは次の形式のテキストです。
+    /// @code
+    /// hpc2014-scores 1
+    /// stages 0 100
+    /// seed 0 123.456789 ...
+    /// seed 1 120.000000 ...
+    /// @endcode
+    class ScoreCompare
+    {
+    public:
+        static const char* const FileHeader;            ///< 得点ファイルの先頭の文字列
+        static const int FileVersion = 1;               ///< 得点ファイルの形式の版
+
+        ScoreCompare();
+
+        /// 2つの得点ファイルを読み込んで比較します。
+        bool run(const char* aBasePath, const char* aCandidatePath);
+        void outputResult()const;                       ///< 比較結果を表示します。
+        bool hasRegression()const;                      ///< 得点が有意に下がったかを返します。
+
+    private:
+        int mStageBegin;                                ///< 比較する最初のステージ番号
+        int mStageEnd;                                  ///< 比較する最後のステージ番号 + 1
+        Statistics mBaseStats[Parameter::GameStageCount];   ///< 各ステージの基準の得点
+        Statistics mCandStats[Parameter::GameStageCount];   ///< 各ステージの比較対象の得点
+        Statistics mDeltaStats[Parameter::GameStageCount];  ///< 各ステージの得点の差
+        Statistics mBaseTotal;                          ///< 基準の合計得点
+        Statistics mCandTotal;                          ///< 比較対象の合計得点
+        Statistics mDeltaTotal;                         ///< 合計得点の差
+        double mStagePValues[Parameter::GameStageCount];    ///< 各ステージの p 値
+        bool mIsStageSignificant[Parameter::GameStageCount]; ///< 各ステージに Holm 法で補正して有意な差があるか
+        double mTotalPValue;                            ///< 合計得点の p 値
+
+        void reset();
+        void judge();
+        bool readHeader(std::FILE* aFile, const char* aPath, int& aStageBegin, int& aStageEnd)const;
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -11,13 +11,40 @@
 
 #include "HPCSimulation.hpp"
 
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
 #include "HPCCommon.hpp"
 #include "HPCMath.hpp"
+#include "HPCProfiler.hpp"
+#include "HPCReplayReader.hpp"
+#include "HPCReplayWriter.hpp"
+#include "HPCStrategy.hpp"
+#include "HPCStrategyRegistry.hpp"
 #include "HPCTimer.hpp"
+#include "HPCWorkerPool.hpp"
 
 namespace {
+    using namespace hpc;
+
+    /// 並列実行時に、各ワーカーと共有する実行結果
+    struct ParallelShared
+    {
+        RecordStage stages[Parameter::GameStageCount];          ///< 各ステージの記録
+        int isDone[Parameter::GameStageCount];                  ///< 各ステージの記録が書き込まれたか
+        Profiler::StageData profiles[Parameter::GameStageCount]; ///< 各ステージの処理時間の集計結果
+        double workerPastSec[WorkerPool::WorkerCountMax];       ///< 各ワーカーの実行時間。実行中は各ワーカーの Timer が更新する
+        int workerTurnCount[WorkerPool::WorkerCountMax];        ///< 各ワーカーが実行したターン数
+        double workerTurnSec[WorkerPool::WorkerCountMax];       ///< 各ワーカーのターンの実行時間
+    };
+
+    /// Simulation::RunWorker に渡すデータ
+    struct WorkerArg
+    {
+        Simulation* sim;
+        ParallelShared* shared;
+    };
+
     /// 入力を受けるコマンド
     enum Command {
         Command_Debug,          ///< デバッガ起動
@@ -156,22 +183,293 @@ namespace hpc {
         : mRandSet()
         , mGame(mRandSet)
         , mTimer(Parameter::GameTimeLimitSec)
+        , mPastSec(0)
+        , mWallSec(0)
+        , mWorkerCount(1)
+        , mStageBegin(0)
+        , mStageEnd(Parameter::GameStageCount)
+        , mIsTimeLimited(true)
+        , mTurnCount(0)
+        , mTurnSec(0)
+        , mStrategy()
+        , mIsProfiled(true)
+        , mProfiler()
+        , mIsDeadlineEnabled(false)
+    {
+        setPlayerStrategy(StrategyRegistry::Default());
+        mGame.setProfiler(&mProfiler);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 乱数のシードを設定し直し、ゲームを実行する前の状態に戻します。
+    ///
+    /// 実行するステージの範囲は変更しません。
+    ///
+    /// @param[in] aSeed 新しく使用する乱数のシード。
+    void Simulation::reset(const RandomSeed& aSeed)
+    {
+        // mGame は mRandSet を参照しているため、インスタンスはそのまま内容を置き換える
+        mRandSet = RandomSet(aSeed);
+        mPastSec = 0;
+        mWallSec = 0;
+        mTurnCount = 0;
+        mTurnSec = 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 実行するステージの範囲を [aBegin, aEnd) に制限します。
+    ///
+    /// 各ステージの乱数列はステージ番号から決まるため、範囲外のステージを
+    /// 実行しなくても、範囲内のステージは全ステージを実行した場合と同じ結果になります。
+    /// 範囲外のステージの得点は 0 になります。
+    ///
+    /// @param[in] aBegin 最初のステージ番号。
+    /// @param[in] aEnd   最後のステージ番号 + 1。
+    void Simulation::setStageRange(int aBegin, int aEnd)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aBegin, 0, Parameter::GameStageCount);
+        HPC_RANGE_ASSERT_MIN_MAX_I(aEnd, aBegin + 1, Parameter::GameStageCount);
+        mStageBegin = aBegin;
+        mStageEnd = aEnd;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 記録の送り先を設定します。
+    ///
+    /// 送り先を設定すると、各ターンの内容はメモリに残らないため、
+    /// JSON の出力やデバッガではターンの内容を参照できなくなります。
+    /// 送り先は 1 つのプロセスからのみ書き込まれることを前提としているため、
+    /// 何もしない送り先以外では run のワーカー数を 1 にする必要があります。
+    ///
+    /// @param[in] aSink 記録の送り先。 0 を指定すると、メモリに記録します。
+    void Simulation::setRecordSink(RecordSink* aSink)
+    {
+        mGame.setRecordSink(aSink);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 制限時間を過ぎたときに、実行中のステージを打ち切るかを設定します。
+    ///
+    /// 打ち切らない場合は、制限時間に関わらずすべてのステージを最後まで実行します。
+    /// 処理速度を計測するときなど、毎回同じ量の処理を行いたい場合に使用します。
+    ///
+    /// @param[in] aIsTimeLimited 打ち切る場合は @c true 。既定値は @c true です。
+    void Simulation::setTimeLimited(bool aIsTimeLimited)
+    {
+        mIsTimeLimited = aIsTimeLimited;
+    }
+
+    //------------------------------------------------------------------------------
+    /// プレイヤーの動作を決める戦略を設定します。
+    ///
+    /// 戦略の状態はこのシミュレーションが所有するので、並列実行時は
+    /// 各ワーカーがそれぞれ別の状態を使います。
+    ///
+    /// @param[in] aStrategy 戦略。既定値は StrategyRegistry::Default() です。
+    ///
+    /// @return 状態を確保できた場合は @c true を返します。
+    bool Simulation::setPlayerStrategy(const Strategy& aStrategy)
     {
+        if (!mStrategy.setup(aStrategy)) {
+            return false;
+        }
+        mGame.setPlayerStrategy(&mStrategy);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 設定されている戦略。
+    const Strategy& Simulation::playerStrategy()const
+    {
+        return mStrategy.strategy();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 集計しない場合、各処理の前後で時刻を読まないので、その分だけ速く実行できます。
+    ///
+    /// @param[in] aIsProfiled 集計する場合は @c true 。既定値は @c true です。
+    void Simulation::setProfiled(bool aIsProfiled)
+    {
+        mIsProfiled = aIsProfiled;
+        mGame.setProfiler(aIsProfiled ? &mProfiler : 0);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 処理時間を集計する場合のみ記録されます。
+    ///
+    /// @param[in] aIsEnabled 記録する場合は @c true 。既定値は @c false です。
+    void Simulation::setLatencyEnabled(bool aIsEnabled)
+    {
+        mProfiler.setLatencyEnabled(aIsEnabled);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 締め切りを使う回答は、締め切りまで探索を深めるので、結果が実行環境や
+    /// 並列数によって変わります。
+    ///
+    /// @param[in] aIsEnabled 締め切りを使わせる場合は @c true 。既定値は @c false です。
+    void Simulation::setDeadlineEnabled(bool aIsEnabled)
+    {
+        mIsDeadlineEnabled = aIsEnabled;
+        mGame.setDeadlineEnabled(aIsEnabled);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 回答に各ターンの締め切りを使わせる場合は @c true 。
+    bool Simulation::isDeadlineEnabled()const
+    {
+        return mIsDeadlineEnabled;
     }
 
     //------------------------------------------------------------------------------
     /// @brief ゲームを実行します。
-    void Simulation::run()
+    ///
+    /// 各ステージはステージ専用の乱数列で実行されるため、ワーカー数によらず
+    /// 同じ結果になります。
+    ///
+    /// @param[in] aWorkerCount ステージを分担して実行するワーカー数。
+    ///                         0 を指定した場合は利用可能なコア数になります。
+    void Simulation::run(int aWorkerCount)
     {
+        const int workerCount = WorkerPool::ValidWorkerCount(aWorkerCount);
+        const double beginSec = Profiler::NowSec();
+        mWorkerCount = workerCount;
+        mTurnCount = 0;
+        mTurnSec = 0;
+        mGame.setupRecord();
+        mGame.setupAnswerState();
+        if (mIsProfiled) {
+            mProfiler.reset();
+        }
+        if (workerCount == 1) {
+            runSerial();
+        } else {
+            runParallel(workerCount);
+        }
+        mGame.onGameDone();
+        mWallSec = Profiler::NowSec() - beginSec;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 1 つのステージを最後まで実行します。
+    ///
+    /// 実行したターン数と、ターンの実行に掛かった時間を加算します。
+    ///
+    /// @param[in] aStageIndex ステージ番号。
+    void Simulation::runStage(int aStageIndex)
+    {
+        mGame.selectStage(aStageIndex);
+        mGame.startStage();
+        const double beginSec = Profiler::NowSec();
         // 制限時間と制限ターン数
+        while (mGame.state() == StageState_Playing && (!mIsTimeLimited || mTimer.isInTime())) {
+            mGame.runTurn();
+            ++mTurnCount;
+        }
+        mTurnSec += Profiler::NowSec() - beginSec;
+        mGame.onStageDone();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 1 つのプロセスで、すべてのステージを順番に実行します。
+    void Simulation::runSerial()
+    {
         mTimer.start();
-        while (mGame.isValidStage()) {
-            mGame.startStage();
-            while (mGame.state() == StageState_Playing && mTimer.isInTime()) {
-                mGame.runTurn();
+        mGame.setupTimeBudget(mTimer, mStageBegin, mStageEnd, 1);
+        for (int index = mStageBegin; index < mStageEnd; ++index) {
+            runStage(index);
+        }
+        mPastSec = mTimer.pastSecForPrint();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 複数のワーカーでステージを分担して実行し、結果を集めます。
+    ///
+    /// 後半のステージほど処理が重いため、ステージは番号順に各ワーカーへ
+    /// 交互に割り当てます。
+    /// 各ワーカーのタイマーは共有メモリを介して経過時間を合算するので、
+    /// 全ワーカーで1つの制限時間を分け合います。実行時間は全ワーカーの合計とし、
+    /// 実時間は wallSec で別に返します。
+    ///
+    /// @param[in] aWorkerCount ワーカー数。
+    void Simulation::runParallel(int aWorkerCount)
+    {
+        const int sharedSize = static_cast<int>(sizeof(ParallelShared));
+        ParallelShared* shared = static_cast<ParallelShared*>(WorkerPool::AllocShared(sharedSize));
+        if (!shared) {
+            HPC_PRINT("Failed to allocate shared memory. Run serially.\n");
+            runSerial();
+            return;
+        }
+
+        WorkerArg arg;
+        arg.sim = this;
+        arg.shared = shared;
+        if (!WorkerPool::Run(aWorkerCount, &Simulation::RunWorker, &arg)) {
+            HPC_PRINT("Some stages may not have been recorded.\n");
+        }
+
+        // 結果を集める
+        for (int index = 0; index < Parameter::GameStageCount; ++index) {
+            if (shared->isDone[index]) {
+                mGame.writeStageRecord(index, shared->stages[index]);
+                if (mIsProfiled) {
+                    mProfiler.setStage(index, shared->profiles[index]);
+                }
             }
-            mGame.onStageDone();
         }
+        mPastSec = 0;
+        mTurnCount = 0;
+        mTurnSec = 0;
+        for (int index = 0; index < aWorkerCount; ++index) {
+            mPastSec += shared->workerPastSec[index];
+            mTurnCount += shared->workerTurnCount[index];
+            mTurnSec += shared->workerTurnSec[index];
+        }
+        if (Parameter::GameTimeLimitSec < mPastSec) {
+            mPastSec = Parameter::GameTimeLimitSec;
+        }
+
+        // 子プロセスを起動できずに呼び出し元で実行した場合、タイマーが共有メモリを参照している
+        mTimer.share(0, 0, 0);
+        WorkerPool::FreeShared(shared, sharedSize);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ワーカーとして、割り当てられたステージを実行します。
+    ///
+    /// @param[in] aWorkerIndex ワーカー番号。
+    /// @param[in] aWorkerCount ワーカー数。
+    /// @param[out] aShared     結果を書き込む共有メモリ。
+    void Simulation::runWorker(int aWorkerIndex, int aWorkerCount, void* aShared)
+    {
+        ParallelShared* shared = static_cast<ParallelShared*>(aShared);
+
+        // 子プロセスを起動できなかったワーカーは呼び出し元で実行されるので、集計を初期化する
+        mTurnCount = 0;
+        mTurnSec = 0;
+        mTimer.share(shared->workerPastSec, aWorkerCount, aWorkerIndex);
+        mTimer.start();
+        mGame.setupTimeBudget(mTimer, mStageBegin + aWorkerIndex, mStageEnd, aWorkerCount);
+        for (int stageIndex = mStageBegin + aWorkerIndex; stageIndex < mStageEnd; stageIndex += aWorkerCount) {
+            runStage(stageIndex);
+
+            // 共有メモリ上のオブジェクトは構築されていないため、そのままコピーする
+            std::memcpy(&shared->stages[stageIndex], &mGame.record().stage(stageIndex), sizeof(RecordStage));
+            shared->profiles[stageIndex] = mProfiler.stage(stageIndex);
+            shared->isDone[stageIndex] = 1;
+        }
+        shared->workerPastSec[aWorkerIndex] = mTimer.ownPastSec();
+        shared->workerTurnCount[aWorkerIndex] = mTurnCount;
+        shared->workerTurnSec[aWorkerIndex] = mTurnSec;
+    }
+
+    //------------------------------------------------------------------------------
+    /// WorkerPool から呼ばれ、 runWorker を実行します。
+    void Simulation::RunWorker(int aWorkerIndex, int aWorkerCount, void* aUserData)
+    {
+        WorkerArg* arg = static_cast<WorkerArg*>(aUserData);
+        arg->sim->runWorker(aWorkerIndex, aWorkerCount, arg->shared);
     }
 
     //------------------------------------------------------------------------------
@@ -180,7 +478,68 @@ namespace hpc {
     {
         HPC_PRINT("Done.\n");
         HPC_PRINT("%8s:%8d\n", "Score", mGame.record().score());
-        HPC_PRINT("%8s:%8.4f\n", "Time", mTimer.pastSecForPrint());
+        HPC_PRINT("%8s:%8.4f\n", "Time", mPastSec);
+        if (1 < mWorkerCount) {
+            HPC_PRINT("%8s:%8.4f\n", "RealTime", mWallSec);
+        }
+        mProfiler.print(mStageBegin, mStageEnd);
+        if (mProfiler.isLatencyEnabled()) {
+            mProfiler.printLatency(mStageBegin, mStageEnd);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return ゲームの記録。
+    const Record& Simulation::record()const
+    {
+        return mGame.record();
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 最後に run を実行したときの実行時間。並列実行時は全ワーカーの合計です。
+    double Simulation::pastSec()const
+    {
+        return mPastSec;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 並列実行時は、全ワーカーの開始から終了までの時間です。
+    ///
+    /// @return 最後に run を実行したときの実時間。
+    double Simulation::wallSec()const
+    {
+        return mWallSec;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 最後に run を実行したときに、全ステージで実行したターン数の合計。
+    int Simulation::turnCount()const
+    {
+        return mTurnCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージの生成や記録の開始を除いた、ターンを進める処理だけの時間です。
+    ///
+    /// @return 最後に run を実行したときの、ターンの実行に掛かった実時間の合計。
+    ///         並列実行時は全ワーカーの合計です。
+    double Simulation::turnSec()const
+    {
+        return mTurnSec;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 実行する最初のステージ番号。
+    int Simulation::stageBegin()const
+    {
+        return mStageBegin;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 実行する最後のステージ番号 + 1 。
+    int Simulation::stageEnd()const
+    {
+        return mStageEnd;
     }
 
     //------------------------------------------------------------------------------
@@ -214,6 +573,65 @@ namespace hpc {
         mGame.record().dumpJson(isCompressed);
     }
 
+    //------------------------------------------------------------------------------
+    /// 記録をバイナリ形式のリプレイファイルに出力します。
+    ///
+    /// @param[in] aPath 出力するファイルのパス。
+    ///
+    /// @return 出力に成功した場合は @c true を返します。
+    bool Simulation::outputReplay(const char* aPath)const
+    {
+        std::FILE* file = std::fopen(aPath, "wb");
+        if (!file) {
+            HPC_PRINT("Failed to open %s.\n", aPath);
+            return false;
+        }
+        bool isSucceeded = false;
+        int size = 0;
+        {
+            ReplayWriter writer(file);
+            mGame.record().writeReplay(writer);
+            isSucceeded = writer.flush();
+            size = writer.writtenSize();
+        }
+        if (std::fclose(file) != 0) {
+            isSucceeded = false;
+        }
+        if (!isSucceeded) {
+            HPC_PRINT("Failed to write %s.\n", aPath);
+            return false;
+        }
+        HPC_PRINT("%8s:%8d bytes\n", "Replay", size);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /// outputReplay で出力したリプレイファイルから記録を読み込みます。
+    /// 読み込んだ記録は outputJson などで出力できます。
+    ///
+    /// @param[in] aPath 読み込むファイルのパス。
+    ///
+    /// @return 読み込みに成功した場合は @c true を返します。
+    bool Simulation::loadReplay(const char* aPath)
+    {
+        std::FILE* file = std::fopen(aPath, "rb");
+        if (!file) {
+            HPC_PRINT("Failed to open %s.\n", aPath);
+            return false;
+        }
+        bool isSucceeded = false;
+        {
+            ReplayReader reader(file);
+            isSucceeded = mGame.readRecord(reader);
+        }
+        std::fclose(file);
+        if (!isSucceeded) {
+            HPC_PRINT("%s is not a valid replay file.\n", aPath);
+            return false;
+        }
+        return true;
+    }
+
     //------------------------------------------------------------------------------
     /// デバッグ実行を行います。
     void Simulation::runDebugger()
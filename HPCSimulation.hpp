@@ -11,7 +11,9 @@
 #pragma once
 
 #include "HPCGame.hpp"
+#include "HPCProfiler.hpp"
 #include "HPCRandomSet.hpp"
+#include "HPCStrategyInstance.hpp"
 #include "HPCTimer.hpp"
 
 namespace hpc {
@@ -23,17 +25,58 @@ namespace hpc {
     public:
         Simulation();
 
-        void run();                                    ///< 開始する
+        void reset(const RandomSeed& aSeed);           ///< シードを指定して初期状態に戻す
+        void setStageRange(int aBegin, int aEnd);      ///< 実行するステージの範囲を設定する
+        void setRecordSink(RecordSink* aSink);         ///< 記録の送り先を設定する
+        void setTimeLimited(bool aIsTimeLimited);      ///< 制限時間でステージを打ち切るかを設定する
+        bool setPlayerStrategy(const Strategy& aStrategy); ///< プレイヤーの戦略を設定する
+        const Strategy& playerStrategy()const;        ///< プレイヤーの戦略を返す。
+        void setProfiled(bool aIsProfiled);           ///< 処理時間を Profiler に集計するかを設定する
+        void setLatencyEnabled(bool aIsEnabled);      ///< 回答の応答時間の分布を記録するかを設定する
+        void setDeadlineEnabled(bool aIsEnabled);     ///< 回答に各ターンの締め切りを使わせるかを設定する
+        bool isDeadlineEnabled()const;                ///< 回答に各ターンの締め切りを使わせるかを返す。
+        void run(int aWorkerCount = 1);               ///< 開始する
         void debug();                                  ///< デバッグする
         void outputResult()const;                     ///< 結果を表示する。
         void outputJson(bool isCompressed)const;      ///< JSON の出力を行う。
+        bool outputReplay(const char* aPath)const;    ///< リプレイファイルの出力を行う。
+        bool loadReplay(const char* aPath);           ///< リプレイファイルから記録を読み込む。
+
+        /// @name 実行結果の取得
+        //@{
+        const Record& record()const;                  ///< ゲームの記録を返す。
+        double pastSec()const;                        ///< 実行に掛かった時間を返す。
+        double wallSec()const;                        ///< 実行に掛かった実時間を返す。
+        int turnCount()const;                         ///< 実行したターン数を返す。
+        double turnSec()const;                        ///< ターンの実行に掛かった時間を返す。
+        int stageBegin()const;                        ///< 実行する最初のステージ番号を返す。
+        int stageEnd()const;                          ///< 実行する最後のステージ番号 + 1 を返す。
+        //@}
         
     private:
         RandomSet mRandSet; ///< 乱数生成クラス
         Game mGame;         ///< シミュレーションするゲーム
         Timer mTimer;       ///< ゲームタイマー
+        double mPastSec;    ///< 実行に掛かった時間
+        double mWallSec;    ///< 実行に掛かった実時間
+        int mWorkerCount;   ///< 最後に実行したときのワーカー数
+        int mStageBegin;    ///< 実行する最初のステージ番号
+        int mStageEnd;      ///< 実行する最後のステージ番号 + 1
+        bool mIsTimeLimited;    ///< 制限時間でステージを打ち切るか
+        int mTurnCount;         ///< 実行したターン数
+        double mTurnSec;        ///< ターンの実行に掛かった時間
+        StrategyInstance mStrategy; ///< プレイヤーの戦略
+        bool mIsProfiled;       ///< 処理時間を Profiler に集計するか
+        Profiler mProfiler;     ///< 処理時間の集計結果
+        bool mIsDeadlineEnabled;    ///< 回答に各ターンの締め切りを使わせるか
 
+        void runStage(int aStageIndex);
+        void runSerial();
+        void runParallel(int aWorkerCount);
+        void runWorker(int aWorkerIndex, int aWorkerCount, void* aShared);
         void runDebugger();
+
+        static void RunWorker(int aWorkerIndex, int aWorkerCount, void* aUserData);
     };
 }
 //------------------------------------------------------------------------------
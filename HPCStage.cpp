@@ -14,6 +14,8 @@
 #include "HPCCommon.hpp"
 #include "HPCLevelDesigner.hpp"
 #include "HPCParameter.hpp"
+#include "HPCRandom.hpp"
+#include "HPCStageSnapshot.hpp"
 
 namespace hpc {
 
@@ -25,6 +27,10 @@ namespace hpc {
         , mField()
         , mTurnResult()
         , mTurnIndex(0)
+        , mTimeBudget()
+        , mPlayerStrategy(0)
+        , mAnswerState(0)
+        , mProfiler(0)
     {
     }
 
@@ -49,6 +55,7 @@ namespace hpc {
     {
         mTurnResult.state = StageState_Playing;
         mTurnIndex = 0;
+        mTimeBudget.setTurnIndex(mTurnIndex);
 
         // Stage情報を基に、各キャラが準備処理を行います。
         for (int index = 0; index < mCharas.count(); ++index) {
@@ -75,15 +82,40 @@ namespace hpc {
     {
         HPC_ASSERT(mTurnResult.state == StageState_Playing);
         mTurnResult.reset();
+        mTimeBudget.setTurnIndex(mTurnIndex);
         
         // 各キャラの動作を確定する
         mCharas.procDecideAction(aRandom);
         
+        execTurn();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各キャラの動作を、 Brain に問い合わせる代わりに aActions で指定してターンを1つ進めます。
+    /// 回答 (Answer.cpp) や乱数は使用しないので、保存した状態からの先読みに使用できます。
+    ///
+    /// @param[in] aActions 各キャラの動作。キャラ数分の要素が必要です。
+    ///                     ゴールしたキャラの要素は無視されます。
+    void Stage::stepWith(const Action* aActions)
+    {
+        HPC_ASSERT(mTurnResult.state == StageState_Playing);
+        mTurnResult.reset();
+        
+        // 各キャラの動作を設定する
+        mCharas.procSetAction(aActions);
+        
+        execTurn();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各キャラの動作が確定した後のターンの処理を行います。
+    void Stage::execTurn()
+    {
         // 動作が確定したら、動作を実行する
-        mCharas.procExecAction();
+        mCharas.procExecAction(*this);
         
         // 動作が実行されたら、キャラ同士の衝突判定を行う
-        mCharas.procCheckColl();
+        mCharas.procCheckColl(*this);
         
         // 衝突判定が終わったら、最終処理を行う
         mCharas.procEnd(*this);
@@ -148,6 +180,38 @@ namespace hpc {
         return mField;
     }
 
+    //------------------------------------------------------------------------------
+    /// 現在の状態を保存します。
+    ///
+    /// @param[out] aSnapshot 保存先。
+    /// @param[in]  aRandom   ゲーム中に使用している乱数。状態が一緒に保存されます。
+    void Stage::save(StageSnapshot& aSnapshot, const Random& aRandom)const
+    {
+        aSnapshot.charaCount = mCharas.count();
+        mCharas.save(aSnapshot.charas, aSnapshot.brains);
+        aSnapshot.lotuses = mLotuses;
+        aSnapshot.field = mField;
+        aSnapshot.turnResult = mTurnResult;
+        aSnapshot.turnIndex = mTurnIndex;
+        aSnapshot.random = aRandom;
+    }
+
+    //------------------------------------------------------------------------------
+    /// save で保存した状態に戻します。
+    ///
+    /// @param[in]  aSnapshot save で保存した状態。
+    /// @param[out] aRandom   ゲーム中に使用する乱数。保存したときの状態に戻ります。
+    void Stage::restore(const StageSnapshot& aSnapshot, Random& aRandom)
+    {
+        HPC_ASSERT(aSnapshot.charaCount == mCharas.count());
+        mCharas.restore(aSnapshot.charas, aSnapshot.brains);
+        mLotuses = aSnapshot.lotuses;
+        mField = aSnapshot.field;
+        mTurnResult = aSnapshot.turnResult;
+        mTurnIndex = aSnapshot.turnIndex;
+        aRandom = aSnapshot.random;
+    }
+
     //------------------------------------------------------------------------------
     /// TurnResultの情報を更新します。
     /// キャラの情報を更新します。
@@ -159,6 +223,69 @@ namespace hpc {
             mTurnResult.charas[index].passedLotusCount = mCharas[index].passedLotusCount();
         }
     }
+
+    //------------------------------------------------------------------------------
+    /// @return 残り時間の見積もり。
+    const TimeBudget& Stage::timeBudget()const
+    {
+        return mTimeBudget;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 残り時間の見積もり。
+    TimeBudget& Stage::timeBudget()
+    {
+        return mTimeBudget;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 設定した戦略は reset で消えないので、以降のステージでも使われます。
+    ///
+    /// @param[in] aStrategy 戦略。 0 を指定すると Answer を直接呼び出します。
+    void Stage::setPlayerStrategy(StrategyInstance* aStrategy)
+    {
+        mPlayerStrategy = aStrategy;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return プレイヤーの戦略。設定されていない場合は 0 。
+    StrategyInstance* Stage::playerStrategy()const
+    {
+        return mPlayerStrategy;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 設定した領域は reset で消えないので、以降のステージでも使われます。
+    ///
+    /// @param[in] aAnswerState StageAccessor::AnswerStateSize バイトの領域。
+    void Stage::setAnswerState(void* aAnswerState)
+    {
+        mAnswerState = aAnswerState;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 解答の状態の領域。
+    void* Stage::answerState()const
+    {
+        HPC_ASSERT(mAnswerState != 0);
+        return mAnswerState;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 設定した集計先は reset で消えないので、以降のステージでも使われます。
+    ///
+    /// @param[in] aProfiler 集計先。 0 を指定すると集計しません。
+    void Stage::setProfiler(Profiler* aProfiler)
+    {
+        mProfiler = aProfiler;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 処理時間の集計先。集計しない場合は 0 。
+    Profiler* Stage::profiler()const
+    {
+        return mProfiler;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -13,10 +13,17 @@
 #include "HPCCharaCollection.hpp"
 #include "HPCField.hpp"
 #include "HPCLotusCollection.hpp"
+#include "HPCTimeBudget.hpp"
 #include "HPCTurnResult.hpp"
 
 namespace hpc {
 
+    class Action;
+    class Profiler;
+    class Random;
+    struct StageSnapshot;
+    class StrategyInstance;
+
     //------------------------------------------------------------------------------
     /// ゲームの1ステージを表します。
     class Stage 
@@ -30,9 +37,16 @@ namespace hpc {
         //@{
         void start();                                   ///< ステージを開始します。
         void runTurn(Random& aRandom);                  ///< ターンを1つ進めます。
+        void stepWith(const Action* aActions);          ///< 指定した動作でターンを1つ進めます。
         const TurnResult& lastTurnResult()const;        ///< 最後のターン実行後の結果を返します。
         //@}
 
+        ///@name 状態の保存と復元
+        //@{
+        void save(StageSnapshot& aSnapshot, const Random& aRandom)const;    ///< 現在の状態を保存します。
+        void restore(const StageSnapshot& aSnapshot, Random& aRandom);      ///< 保存した状態に戻します。
+        //@}
+
         /// @name 各要素へのアクセス
         //@{
         const CharaCollection& charas()const;       ///< キャラ情報を返します。
@@ -41,15 +55,29 @@ namespace hpc {
         LotusCollection& lotuses();                 ///< 蓮情報を返します。
         const Field& field()const;                  ///< フィールド情報を返します。
         Field& field();                             ///< フィールド情報を返します。
+        const TimeBudget& timeBudget()const;        ///< 残り時間の見積もりを返します。
+        TimeBudget& timeBudget();                   ///< 残り時間の見積もりを返します。
         //@}
 
+        void setPlayerStrategy(StrategyInstance* aStrategy);    ///< プレイヤーの戦略を設定します。
+        StrategyInstance* playerStrategy()const;                ///< プレイヤーの戦略を返します。
+        void setAnswerState(void* aAnswerState);    ///< 解答の状態の領域を設定します。
+        void* answerState()const;                   ///< 解答の状態の領域を返します。
+        void setProfiler(Profiler* aProfiler);      ///< 処理時間の集計先を設定します。
+        Profiler* profiler()const;                  ///< 処理時間の集計先を返します。
+
     private:
         CharaCollection mCharas;        ///< キャラ情報
         LotusCollection mLotuses;       ///< 蓮情報
         Field mField;                   ///< フィールド情報
         TurnResult mTurnResult;         ///< ターンの実行結果
         int mTurnIndex;                 ///< 現在のターン番号
+        TimeBudget mTimeBudget;         ///< 残り時間の見積もり。ステージをまたいで保持します
+        StrategyInstance* mPlayerStrategy;  ///< プレイヤーの戦略。ステージをまたいで保持します
+        void* mAnswerState;             ///< 解答の状態の領域。 Game が所有します
+        Profiler* mProfiler;            ///< 処理時間の集計先。集計しなければ 0
 
+        void execTurn();            ///< 動作が決まった後のターンの処理を行います。
         void updateTurnResult();    ///< TurnResultを更新します。
     };
 }
@@ -71,6 +71,27 @@ namespace hpc {
     {
         return mStagePtr->field();
     }
+
+    //------------------------------------------------------------------------------
+    /// 制限時間内にすべてのステージを終えられるよう、
+    /// 探索などに使う時間を調整するために使います。
+    ///
+    /// @return 残り時間の見積もり。
+    const TimeBudget& StageAccessor::timeBudget()const
+    {
+        return mStagePtr->timeBudget();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 解答はステージをまたいで使う状態をこの領域に持ちます。
+    /// 領域はゲームごとに別なので、1つのプロセスで複数のゲームを同時に実行できます。
+    /// ゲームの開始時にゼロで初期化されます。
+    ///
+    /// @return AnswerStateSize バイトの領域。
+    void* StageAccessor::answerState()const
+    {
+        return mStagePtr->answerState();
+    }
 }
 //------------------------------------------------------------------------------
 // EOF
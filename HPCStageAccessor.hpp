@@ -13,6 +13,7 @@
 #include "HPCEnemyAccessor.hpp"
 #include "HPCField.hpp"
 #include "HPCLotusCollection.hpp"
+#include "HPCTimeBudget.hpp"
 
 namespace hpc {
 
@@ -28,6 +29,9 @@ namespace hpc {
     class StageAccessor
     {
     public:
+        /// 解答が1つのゲームの間使える領域のバイト数
+        static const int AnswerStateSize = 16 * 1024;
+
         StageAccessor();
 
         void init(const Stage& aStage, int aPlayerIndex);    ///< 初期設定を行います。
@@ -38,6 +42,8 @@ namespace hpc {
         const EnemyAccessor& enemies()const;        ///< 敵キャラ情報を返します。
         const LotusCollection& lotuses()const;      ///< 蓮情報を返します。
         const Field& field()const;                  ///< フィールド情報を返します。
+        const TimeBudget& timeBudget()const;        ///< 残り時間の見積もりを返します。
+        void* answerState()const;                   ///< 解答が1つのゲームの間使える領域を返します。
         //@}
 
     private:
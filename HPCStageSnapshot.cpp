@@ -0,0 +1,32 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCStageSnapshot.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCStageSnapshot.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 空の状態でインスタンスを生成します。
+    StageSnapshot::StageSnapshot()
+        : charaCount(0)
+        , charas()
+        , brains()
+        , lotuses()
+        , field()
+        , turnResult()
+        , turnIndex(0)
+        , random(0, 0)
+    {
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
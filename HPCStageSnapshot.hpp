@@ -0,0 +1,47 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    StageSnapshot 構造体
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCBrain.hpp"
+#include "HPCCharaHotBlock.hpp"
+#include "HPCField.hpp"
+#include "HPCLotusCollection.hpp"
+#include "HPCParameter.hpp"
+#include "HPCRandom.hpp"
+#include "HPCTurnResult.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 実行中のステージの状態を保存したものです。
+    ///
+    /// Stage::save で保存し、 Stage::restore で復元します。
+    /// すべてのメンバはポインタを含まないので、 std::memcpy でコピーできます。
+    /// brains は Brain::save で保存するので、プレイヤーの戦略へのポインタは 0 になります。
+    ///
+    /// @note 回答 (Answer.cpp) や戦略が内部に持つ状態は含まれません。
+    ///       また、保存したときと同じステージを開始した Stage にのみ復元できます。
+    struct StageSnapshot
+    {
+        StageSnapshot();
+
+        int charaCount;                                     ///< 有効なキャラ数
+        CharaHotBlock charas;                               ///< キャラの位置や速度など
+        Brain brains[Parameter::CharaCountMax];             ///< キャラの動作決定モジュールの状態 (戦略を除く)
+        LotusCollection lotuses;                            ///< 蓮情報
+        Field field;                                        ///< フィールド情報
+        TurnResult turnResult;                              ///< 最後のターンの実行結果
+        int turnIndex;                                      ///< 現在のターン番号
+        Random random;                                      ///< ゲーム中に使用する乱数の状態
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCStatistics.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCStatistics.hpp"
+
+#include <cmath>
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 標本が空の状態でインスタンスを生成します。
+    Statistics::Statistics()
+        : mCount(0)
+        , mMean(0)
+        , mSumSq(0)
+        , mMin(0)
+        , mMax(0)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// 標本をすべて破棄し、生成直後の状態に戻します。
+    void Statistics::reset()
+    {
+        *this = Statistics();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 標本を 1 つ追加します。
+    ///
+    /// @param[in] aValue 追加する値。
+    void Statistics::add(double aValue)
+    {
+        if (mCount == 0 || aValue < mMin) {
+            mMin = aValue;
+        }
+        if (mCount == 0 || mMax < aValue) {
+            mMax = aValue;
+        }
+        ++mCount;
+        const double delta = aValue - mMean;
+        mMean += delta / mCount;
+        mSumSq += delta * (aValue - mMean);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 追加された標本の数。
+    int Statistics::count()const
+    {
+        return mCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 標本の平均。標本が無い場合は 0 です。
+    double Statistics::mean()const
+    {
+        return mMean;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 標本標準偏差 (n - 1 で割ったもの) 。標本が 2 つ未満の場合は 0 です。
+    double Statistics::stddev()const
+    {
+        if (mCount < 2) {
+            return 0;
+        }
+        return std::sqrt(mSumSq / (mCount - 1));
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 標本の最小値。標本が無い場合は 0 です。
+    double Statistics::min()const
+    {
+        return mMin;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 標本の最大値。標本が無い場合は 0 です。
+    double Statistics::max()const
+    {
+        return mMax;
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
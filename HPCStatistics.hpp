@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Statistics クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 標本を逐次追加し、平均や標準偏差などの統計量を求めます。
+    ///
+    /// 標本そのものは保持せず、 Welford の方法で平均と偏差平方和を更新します。
+    class Statistics
+    {
+    public:
+        Statistics();
+
+        void reset();                   ///< 標本をすべて破棄します。
+        void add(double aValue);        ///< 標本を追加します。
+
+        /// @name 統計量の取得
+        //@{
+        int count()const;               ///< 標本数を返します。
+        double mean()const;             ///< 平均を返します。
+        double stddev()const;           ///< 標本標準偏差を返します。
+        double min()const;              ///< 最小値を返します。
+        double max()const;              ///< 最大値を返します。
+        //@}
+
+    private:
+        int mCount;         ///< 標本数
+        double mMean;       ///< 平均
+        double mSumSq;      ///< 平均からの偏差の平方和
+        double mMin;        ///< 最小値
+        double mMax;        ///< 最大値
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
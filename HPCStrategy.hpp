@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Strategy 構造体
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCAction.hpp"
+
+namespace hpc {
+
+    class StageAccessor;
+
+    //------------------------------------------------------------------------------
+    /// プレイヤーの動作を決める戦略を表します。
+    ///
+    /// 戦略は Answer::Init, Answer::GetNextAction と同じ役割の関数の組です。
+    /// 戦略が使う状態は StrategyInstance が stateSize バイトだけ確保し、
+    /// 各関数に渡します。状態をグローバル変数に持たないので、
+    /// 同じ戦略を複数のゲームで同時に使うことができます。
+    /// 状態はゼロで初期化された状態で渡されます。
+    struct Strategy
+    {
+        /// 各ステージ開始時に呼び出される関数の型
+        ///
+        /// @param[in,out] aState         戦略の状態。
+        /// @param[in]     aStageAccessor 現在ステージの情報。
+        typedef void (*InitFunc)(void* aState, const StageAccessor& aStageAccessor);
+        /// 各ターンの動作を決める関数の型
+        ///
+        /// @param[in,out] aState         戦略の状態。
+        /// @param[in]     aStageAccessor 現在ステージの情報。
+        ///
+        /// @return これから行う動作。
+        typedef Action (*GetNextActionFunc)(void* aState, const StageAccessor& aStageAccessor);
+
+        const char* name;                   ///< コマンドラインで指定する名前
+        const char* description;            ///< 一覧に表示する説明
+        int stateSize;                      ///< 状態のバイト数。状態を持たない場合は 0
+        InitFunc init;                      ///< 各ステージ開始時に呼び出される関数
+        GetNextActionFunc getNextAction;    ///< 各ターンの動作を決める関数
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
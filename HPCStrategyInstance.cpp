@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCStrategyInstance.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCStrategyInstance.hpp"
+
+#include <cstdlib>
+#include "HPCCommon.hpp"
+#include "HPCStrategy.hpp"
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 戦略が設定されていない状態でインスタンスを生成します。
+    StrategyInstance::StrategyInstance()
+        : mStrategy(0)
+        , mState(0)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    StrategyInstance::~StrategyInstance()
+    {
+        release();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 以前に設定されていた戦略の状態は解放されます。
+    ///
+    /// @param[in] aStrategy 使用する戦略。インスタンスを使い終わるまで保持しておく必要があります。
+    ///
+    /// @return 状態を確保できた場合は @c true を返します。
+    bool StrategyInstance::setup(const Strategy& aStrategy)
+    {
+        HPC_ASSERT(0 <= aStrategy.stateSize);
+        release();
+        if (0 < aStrategy.stateSize) {
+            mState = std::calloc(1, aStrategy.stateSize);
+            if (!mState) {
+                return false;
+            }
+        }
+        mStrategy = &aStrategy;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    void StrategyInstance::release()
+    {
+        std::free(mState);
+        mState = 0;
+        mStrategy = 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return setup に成功していれば @c true を返します。
+    bool StrategyInstance::isValid()const
+    {
+        return mStrategy != 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 設定されている戦略。
+    const Strategy& StrategyInstance::strategy()const
+    {
+        HPC_ASSERT(isValid());
+        return *mStrategy;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aStageAccessor 現在ステージの情報。
+    void StrategyInstance::init(const StageAccessor& aStageAccessor)
+    {
+        HPC_ASSERT(isValid());
+        mStrategy->init(mState, aStageAccessor);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aStageAccessor 現在ステージの情報。
+    ///
+    /// @return これから行う動作。
+    Action StrategyInstance::getNextAction(const StageAccessor& aStageAccessor)
+    {
+        HPC_ASSERT(isValid());
+        return mStrategy->getNextAction(mState, aStageAccessor);
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
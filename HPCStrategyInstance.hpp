@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    StrategyInstance クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCAction.hpp"
+
+namespace hpc {
+
+    class StageAccessor;
+    struct Strategy;
+
+    //------------------------------------------------------------------------------
+    /// 戦略と、その戦略が使う状態の組を表します。
+    ///
+    /// 1つのゲームのプレイヤーは1つの StrategyInstance を使います。
+    /// 状態はインスタンスごとに確保するので、同じ戦略のインスタンスは互いに影響しません。
+    class StrategyInstance
+    {
+    public:
+        StrategyInstance();
+        ~StrategyInstance();
+
+        bool setup(const Strategy& aStrategy);          ///< 使用する戦略を設定し、状態を確保します。
+        void release();                                 ///< 戦略の設定を解除し、状態を解放します。
+        bool isValid()const;                            ///< 戦略が設定されているかを返します。
+        const Strategy& strategy()const;                ///< 設定されている戦略を返します。
+
+        void init(const StageAccessor& aStageAccessor); ///< 各ステージ開始時の処理を行います。
+        Action getNextAction(const StageAccessor& aStageAccessor);  ///< 次の動作を返します。
+
+    private:
+        const Strategy* mStrategy;                      ///< 設定されている戦略
+        void* mState;                                   ///< 戦略の状態
+
+        // 状態を所有しているため、コピーは禁止します。
+        StrategyInstance(const StrategyInstance&);
+        StrategyInstance& operator=(const StrategyInstance&);
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
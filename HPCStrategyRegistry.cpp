@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCStrategyRegistry.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCStrategyRegistry.hpp"
+
+#include <cstring>
+#include "HPCAnswer.hpp"
+#include "HPCBrain.hpp"
+#include "HPCCommon.hpp"
+#include "HPCRandom.hpp"
+#include "HPCStrategy.hpp"
+
+namespace {
+    using namespace hpc;
+
+    //------------------------------------------------------------------------------
+    /// Answer.cpp の Answer::Init を呼び出します。
+    /// Answer.cpp は状態を StageAccessor::answerState() の領域に持つので、戦略の状態は使いません。
+    void AnswerInit(void*, const StageAccessor& aStageAccessor)
+    {
+        Answer::Init(aStageAccessor);
+    }
+
+    //------------------------------------------------------------------------------
+    /// Answer.cpp の Answer::GetNextAction を呼び出します。
+    Action AnswerGetNextAction(void*, const StageAccessor& aStageAccessor)
+    {
+        return Answer::GetNextAction(aStageAccessor);
+    }
+
+    /// CPU と同じ方針で動く戦略の状態
+    struct CpuState
+    {
+        int saveAccelTurn;              ///< 加速を節約して待機したターン数
+        uint seedX;                     ///< 乱数のシード
+        uint seedY;                     ///< 乱数のシード
+    };
+
+    //------------------------------------------------------------------------------
+    /// 乱数のシードはプレイヤーの開始位置から決めるので、
+    /// ワーカー数や実行するステージの範囲によらず、同じステージでは同じ動作になります。
+    void CpuInit(void* aState, const StageAccessor& aStageAccessor)
+    {
+        CpuState& state = *static_cast<CpuState*>(aState);
+        const Vec2 pos = aStageAccessor.player().pos();
+        state.saveAccelTurn = 0;
+        state.seedX = static_cast<uint>(pos.x * 1024.0f) * 2654435761u + 1u;
+        state.seedY = static_cast<uint>(pos.y * 1024.0f) * 2246822519u + 1u;
+    }
+
+    //------------------------------------------------------------------------------
+    /// Brain::CpuNextAction で、 CPU と同じ方針の動作を決めます。
+    Action CpuGetNextAction(void* aState, const StageAccessor& aStageAccessor)
+    {
+        CpuState& state = *static_cast<CpuState*>(aState);
+        const Chara& player = aStageAccessor.player();
+        Random random(state.seedX, state.seedY);
+        const Action action = Brain::CpuNextAction(
+            player.pos()
+            , player.accelCount()
+            , aStageAccessor.lotuses()[player.targetLotusNo()].pos()
+            , state.saveAccelTurn
+            , random
+            );
+        // 次のターンは続きの乱数を使う
+        state.seedX = static_cast<uint>(random.randMinMax(0, 0x7fffffff)) + 1u;
+        state.seedY = static_cast<uint>(random.randMinMax(0, 0x7fffffff)) + 1u;
+        return action;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 加速できるときは常に次の蓮の中心へ加速します。比較の基準に使う単純な戦略です。
+    Action GreedyGetNextAction(void*, const StageAccessor& aStageAccessor)
+    {
+        const Chara& player = aStageAccessor.player();
+        if (0 < player.accelCount()) {
+            return Action(ActionType_Accel, aStageAccessor.lotuses()[player.targetLotusNo()].pos());
+        }
+        return Action(ActionType_Wait, Vec2());
+    }
+
+    //------------------------------------------------------------------------------
+    void NoInit(void*, const StageAccessor&)
+    {
+    }
+
+    /// 組み込まれている戦略の一覧。先頭が既定の戦略です。
+    const Strategy Strategies[] = {
+        {
+            "answer"
+            , "Answer.cpp"
+            , 0
+            , AnswerInit
+            , AnswerGetNextAction
+        },
+        {
+            "cpu"
+            , "CPU と同じ方針 (Brain::CpuNextAction)"
+            , static_cast<int>(sizeof(CpuState))
+            , CpuInit
+            , CpuGetNextAction
+        },
+        {
+            "greedy"
+            , "加速できるときは常に次の蓮へ加速"
+            , 0
+            , NoInit
+            , GreedyGetNextAction
+        },
+    };
+    const int StrategyCount = static_cast<int>(sizeof(Strategies) / sizeof(Strategies[0]));
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// @return 登録されている戦略の数。
+    int StrategyRegistry::Count()
+    {
+        return StrategyCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex 戦略の番号。 [0, Count()) の範囲で指定します。
+    ///
+    /// @return 登録されている戦略。
+    const Strategy& StrategyRegistry::Get(int aIndex)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, StrategyCount);
+        return Strategies[aIndex];
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return Answer.cpp を使う既定の戦略。
+    const Strategy& StrategyRegistry::Default()
+    {
+        return Strategies[0];
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aName 戦略の名前。
+    ///
+    /// @return 見つかった戦略。見つからない場合は 0 を返します。
+    const Strategy* StrategyRegistry::Find(const char* aName)
+    {
+        for (int index = 0; index < StrategyCount; ++index) {
+            if (!std::strcmp(Strategies[index].name, aName)) {
+                return &Strategies[index];
+            }
+        }
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    void StrategyRegistry::PrintList()
+    {
+        for (int index = 0; index < StrategyCount; ++index) {
+            HPC_PRINT("  %-12s %s\n", Strategies[index].name, Strategies[index].description);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,36 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    StrategyRegistry クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    struct Strategy;
+
+    //------------------------------------------------------------------------------
+    /// 実行ファイルに組み込まれている戦略の一覧を提供します。
+    ///
+    /// 戦略を追加する場合は、 Strategy を定義して HPCStrategyRegistry.cpp の
+    /// 一覧に加えます。最初の戦略 ("answer") が既定の戦略です。
+    class StrategyRegistry
+    {
+    public:
+        static int Count();                             ///< 登録されている戦略の数を返します。
+        static const Strategy& Get(int aIndex);         ///< 登録されている戦略を返します。
+        static const Strategy& Default();               ///< 既定の戦略を返します。
+        static const Strategy* Find(const char* aName); ///< 名前で戦略を探します。
+        static void PrintList();                        ///< 戦略の一覧を表示します。
+
+    private:
+        StrategyRegistry();
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCThroughput.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCThroughput.hpp"
+
+#include <cstdio>
+#include "HPCCommon.hpp"
+#include "HPCJsonWriter.hpp"
+#include "HPCProfiler.hpp"
+#include "HPCRandomSeed.hpp"
+#include "HPCRecordSink.hpp"
+#include "HPCSimulation.hpp"
+#include "HPCStrategy.hpp"
+#include "HPCStrategyRegistry.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define HPC_THROUGHPUT_RUSAGE
+    #include <sys/resource.h>
+#endif
+
+namespace {
+    using namespace hpc;
+
+    /// 出力に使う各条件の名前
+    const char* const ModeNames[ThroughputMode_TERM] = {
+        "no_record",
+        "record",
+        "record_json",
+    };
+
+    //------------------------------------------------------------------------------
+    /// 0 で割らないように、1秒あたりの数を求めます。
+    double PerSec(double aCount, double aSec)
+    {
+        return 0 < aSec ? aCount / aSec : 0;
+    }
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 1 回ずつ実行する設定でインスタンスを生成します。
+    Throughput::Throughput()
+        : mRunCount(1)
+        , mStrategyName("")
+        , mStageBegin(0)
+        , mStageEnd(0)
+        , mResults()
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aRunCount 各条件でゲームを実行する回数。 [1, RunCountMax] の範囲で指定します。
+    void Throughput::setRunCount(int aRunCount)
+    {
+        HPC_RANGE_ASSERT_MIN_MAX_I(aRunCount, 1, RunCountMax);
+        mRunCount = aRunCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 加速できるときは常に加速する "greedy" は、ターンごとの処理量が一定なので、
+    /// ゲーム自体の処理速度を計測できます。
+    ///
+    /// @return 戦略を指定しない場合に計測に使う戦略。
+    const Strategy& Throughput::DefaultStrategy()
+    {
+        const Strategy* strategy = StrategyRegistry::Find("greedy");
+        HPC_ASSERT(strategy);
+        return *strategy;
+    }
+
+    //------------------------------------------------------------------------------
+    /// すべての条件でゲームを実行し、処理速度を計測します。
+    ///
+    /// 記録の領域を確保しない条件から順に計測するので、各条件のピークメモリ使用量は
+    /// その条件までに必要になった量を表します。
+    /// 実行するステージの範囲と戦略は aSim に設定されたものに従います。
+    ///
+    /// @param[in,out] aSim ゲームの実行に使う Simulation 。
+    void Throughput::run(Simulation& aSim)
+    {
+        mStrategyName = aSim.playerStrategy().name;
+        mStageBegin = aSim.stageBegin();
+        mStageEnd = aSim.stageEnd();
+        aSim.setTimeLimited(false);
+        for (int mode = 0; mode < ThroughputMode_TERM; ++mode) {
+            runMode(aSim, static_cast<ThroughputMode>(mode));
+        }
+        aSim.setTimeLimited(true);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aMode 計測の条件。
+    ///
+    /// @return 計測結果。
+    const Throughput::Result& Throughput::result(ThroughputMode aMode)const
+    {
+        HPC_ENUM_ASSERT(ThroughputMode, aMode);
+        return mResults[aMode];
+    }
+
+    //------------------------------------------------------------------------------
+    /// 夜間の計測などで集計しやすいように、結果を JSON で標準出力へ表示します。
+    void Throughput::outputResult()const
+    {
+        HPC_PRINT("{\n");
+        HPC_PRINT("    \"strategy\": \"%s\",\n", mStrategyName);
+        HPC_PRINT("    \"runs\": %d,\n", mRunCount);
+        HPC_PRINT("    \"stage_begin\": %d,\n", mStageBegin);
+        HPC_PRINT("    \"stage_end\": %d,\n", mStageEnd);
+        HPC_PRINT("    \"modes\": {\n");
+        for (int mode = 0; mode < ThroughputMode_TERM; ++mode) {
+            const Result& result = mResults[mode];
+            HPC_PRINT("        \"%s\": {", ModeNames[mode]);
+            HPC_PRINT("\"turns\": %d, ", result.turnCount);
+            HPC_PRINT("\"stages\": %d, ", result.stageCount);
+            HPC_PRINT("\"wall_sec\": %.6f, ", result.wallSec);
+            HPC_PRINT("\"turns_per_sec\": %.3f, ", PerSec(result.turnCount, result.wallSec));
+            HPC_PRINT("\"stages_per_sec\": %.3f, ", PerSec(result.stageCount, result.wallSec));
+            HPC_PRINT("\"ns_per_turn\": %.3f, "
+                , result.turnCount == 0 ? 0 : result.turnSec * 1.0e9 / result.turnCount
+                );
+            HPC_PRINT("\"peak_rss_kb\": %ld}", result.peakRssKb);
+            HPC_PRINT(mode + 1 < ThroughputMode_TERM ? ",\n" : "\n");
+        }
+        HPC_PRINT("    }\n");
+        HPC_PRINT("}\n");
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return プロセスが起動してからのピークメモリ使用量 (KB) 。取得できない場合は 0 を返します。
+    long Throughput::PeakRssKb()
+    {
+#ifdef HPC_THROUGHPUT_RUSAGE
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    #ifdef __APPLE__
+            // macOS ではバイト単位
+            return usage.ru_maxrss / 1024;
+    #else
+            return usage.ru_maxrss;
+    #endif
+        }
+#endif
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 1つの条件で、ゲームを mRunCount 回続けて実行します。
+    ///
+    /// @param[in,out] aSim  ゲームの実行に使う Simulation 。
+    /// @param[in]     aMode 計測の条件。
+    void Throughput::runMode(Simulation& aSim, ThroughputMode aMode)
+    {
+        HPC_ENUM_ASSERT(ThroughputMode, aMode);
+
+        RecordSink nullSink;
+        aSim.setRecordSink(aMode == ThroughputMode_NoRecord ? &nullSink : 0);
+        // JSON は出力する処理だけを計測するので、捨てられる一時ファイルに書く
+        std::FILE* jsonFile = 0;
+        if (aMode == ThroughputMode_RecordJson) {
+            jsonFile = std::tmpfile();
+            if (!jsonFile) {
+                HPC_PRINT("Failed to open a temporary file. JSON is not output.\n");
+            }
+        }
+
+        Result& result = mResults[aMode];
+        result.runCount = mRunCount;
+        result.stageCount = 0;
+        result.turnCount = 0;
+        result.wallSec = 0;
+        result.turnSec = 0;
+        for (int count = 0; count < mRunCount; ++count) {
+            aSim.reset(RandomSeed());
+            const double beginSec = Profiler::NowSec();
+            aSim.run(1);
+            if (jsonFile) {
+                std::rewind(jsonFile);
+                JsonWriter writer(jsonFile, true);
+                aSim.record().dumpJson(writer);
+                writer.flush();
+            }
+            result.wallSec += Profiler::NowSec() - beginSec;
+            result.stageCount += mStageEnd - mStageBegin;
+            result.turnCount += aSim.turnCount();
+            result.turnSec += aSim.turnSec();
+        }
+        result.peakRssKb = PeakRssKb();
+
+        if (jsonFile) {
+            std::fclose(jsonFile);
+        }
+        aSim.setRecordSink(0);
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Throughput クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCThroughputMode.hpp"
+
+namespace hpc {
+
+    class Simulation;
+    struct Strategy;
+
+    //------------------------------------------------------------------------------
+    /// ゲーム全体を何度も実行して、1秒あたりに処理できるターン数などを計測します。
+    ///
+    /// 各条件 ( ThroughputMode ) ごとに、同じシードのゲームを指定回数だけ続けて実行します。
+    /// ゲームは Simulation を設定し直して実行するので、記録の領域などは使い回されます。
+    /// 毎回同じ量の処理を計測できるように、制限時間でステージを打ち切りません。
+    /// ワーカー数による差が出ないように、すべて1つのプロセスで実行します。
+    ///
+    /// 回答は制限時間に応じて探索の量を変えることがあり、その場合は回答の探索に
+    /// 使った時間を計測してしまいます。ゲームの処理速度を計測するときは、
+    /// 処理量が一定の戦略 ( DefaultStrategy ) を使います。
+    class Throughput
+    {
+    public:
+        static const int RunCountMax = 10000;           ///< 指定できる実行回数の上限
+
+        /// 1つの条件の計測結果
+        struct Result
+        {
+            int runCount;                               ///< ゲームの実行回数
+            int stageCount;                             ///< 実行したステージ数の合計
+            int turnCount;                              ///< 実行したターン数の合計
+            double wallSec;                             ///< 記録の出力を含む全体の実時間
+            double turnSec;                             ///< ターンの実行に掛かった実時間
+            long peakRssKb;                             ///< 計測後のピークメモリ使用量 (KB)
+        };
+
+        Throughput();
+
+        void setRunCount(int aRunCount);                ///< 各条件でゲームを実行する回数を設定します。
+        static const Strategy& DefaultStrategy();       ///< 戦略を指定しない場合に計測に使う戦略を返します。
+        void run(Simulation& aSim);                     ///< すべての条件で計測します。
+        const Result& result(ThroughputMode aMode)const; ///< 計測結果を返します。
+        void outputResult()const;                       ///< 計測結果を JSON で表示します。
+
+        static long PeakRssKb();                        ///< プロセスのピークメモリ使用量を返します。
+
+    private:
+        int mRunCount;                                  ///< 各条件でゲームを実行する回数
+        const char* mStrategyName;                      ///< 計測した戦略の名前
+        int mStageBegin;                                ///< 計測した最初のステージ番号
+        int mStageEnd;                                  ///< 計測した最後のステージ番号 + 1
+        Result mResults[ThroughputMode_TERM];           ///< 各条件の計測結果
+
+        void runMode(Simulation& aSim, ThroughputMode aMode);
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
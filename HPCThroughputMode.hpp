@@ -0,0 +1,26 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    ThroughputMode 列挙型
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// @brief Throughput で処理速度を計測する条件を定義します。
+    enum ThroughputMode {
+        ThroughputMode_NoRecord,    ///< 各ターンの内容を記録しない
+        ThroughputMode_Record,      ///< 各ターンの内容をメモリに記録する
+        ThroughputMode_RecordJson,  ///< 記録した上で、ゲームごとに JSON を出力する
+
+        ThroughputMode_TERM
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,230 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCTimeBudget.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCTimeBudget.hpp"
+
+#include "HPCCommon.hpp"
+#include "HPCLevelDesigner.hpp"
+#include "HPCMath.hpp"
+#include "HPCParameter.hpp"
+#include "HPCProfiler.hpp"
+#include "HPCTimer.hpp"
+
+namespace hpc {
+
+    const float TimeBudget::PriorTurnPerScale = 2.0f;
+    const float TimeBudget::ReserveRate = 0.1f;
+
+    //------------------------------------------------------------------------------
+    /// タイマーが設定されていない状態でインスタンスを生成します。
+    /// この状態では、残り時間は常に制限時間そのものになります。
+    TimeBudget::TimeBudget()
+        : mTimer(0)
+        , mStageEnd(Parameter::GameStageCount)
+        , mStageStep(1)
+        , mStageIndex(0)
+        , mTurnIndex(0)
+        , mDoneTurnCount(0)
+        , mDoneScale(0)
+        , mNextTurnCount(0)
+        , mTurnEndSec(0)
+        , mIsDeadlineEnabled(false)
+    {
+        updateNextTurnCount();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 計測するタイマーと、実行するステージを設定します。
+    /// 実行するステージは aStageBegin から aStageStep おきに、 aStageEnd の手前までです。
+    ///
+    /// @param[in] aTimer      ゲームの制限時間を計測するタイマー。計測を開始している必要があります。
+    /// @param[in] aStageBegin 最初のステージ番号。
+    /// @param[in] aStageEnd   最後のステージ番号 + 1。
+    /// @param[in] aStageStep  ステージ番号の間隔。並列実行時はワーカー数です。
+    void TimeBudget::setup(
+        const Timer& aTimer
+        , int aStageBegin
+        , int aStageEnd
+        , int aStageStep
+        )
+    {
+        HPC_LB_ASSERT_I(aStageStep, 0);
+        mTimer = &aTimer;
+        mStageEnd = aStageEnd;
+        mStageStep = aStageStep;
+        mStageIndex = aStageBegin;
+        mTurnIndex = 0;
+        mDoneTurnCount = 0;
+        mDoneScale = 0;
+        updateNextTurnCount();
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aStageIndex 開始するステージ番号。
+    void TimeBudget::startStage(int aStageIndex)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aStageIndex, 0, Parameter::GameStageCount);
+        mStageIndex = aStageIndex;
+        mTurnIndex = 0;
+        updateNextTurnCount();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 締め切りが有効な場合は、このターンの締め切りを現在の時刻から turnAllowanceSec() 後に設定します。
+    /// 無効な場合は時計を読まないので、毎ターン呼び出しても処理時間は増えません。
+    ///
+    /// @param[in] aTurnIndex 実行中のステージのターン番号。
+    void TimeBudget::setTurnIndex(int aTurnIndex)
+    {
+        mTurnIndex = aTurnIndex;
+        if (mIsDeadlineEnabled) {
+            mTurnEndSec = Profiler::NowSec() + turnAllowanceSec();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 実行し終えたステージのターン数を、見積もりに反映します。
+    void TimeBudget::endStage()
+    {
+        mDoneTurnCount += mTurnIndex + 1;
+        mDoneScale += LevelDesigner::StageScale(mStageIndex);
+        mStageIndex += mStageStep;
+        mTurnIndex = 0;
+        updateNextTurnCount();
+    }
+
+    //------------------------------------------------------------------------------
+    /// 締め切りで探索を打ち切る回答は、実行環境や並列数によって結果が変わるので、
+    /// 既定では使いません。 setup を呼び出しても設定は変わりません。
+    ///
+    /// @param[in] aIsEnabled 締め切りを使う場合は @c true 。既定値は @c false です。
+    void TimeBudget::setDeadlineEnabled(bool aIsEnabled)
+    {
+        mIsDeadlineEnabled = aIsEnabled;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return ゲーム全体の制限時間までの残り時間 (秒)。超過している場合は 0 です。
+    double TimeBudget::restSec()const
+    {
+        if (!mTimer) {
+            return Parameter::GameTimeLimitSec;
+        }
+        return mTimer->restSec();
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 実行中のステージの残りと、これから実行するステージのターン数の合計の見積もり。
+    int TimeBudget::expectedRestTurnCount()const
+    {
+        if (mStageEnd <= mStageIndex) {
+            return 0;
+        }
+        return expectedStageRestTurnCount() + mNextTurnCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 見積もりより長く掛かっている場合も、見積もりの 1 割は残っているとみなします。
+    ///
+    /// @return 実行中のステージの、現在のターンを含む残りのターン数の見積もり。
+    int TimeBudget::expectedStageRestTurnCount()const
+    {
+        if (mStageEnd <= mStageIndex) {
+            return 0;
+        }
+        const int turnCount = expectedTurnCount(mStageIndex);
+        const int restTurnCount = Math::Max(turnCount - mTurnIndex, turnCount / 10 + 1);
+        return Math::Min(restTurnCount, Parameter::GameTurnPerStage - mTurnIndex);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 制限時間の ReserveRate の割合を予備として除いた残り時間を、残りのターン数の見積もりで等分した時間です。
+    /// 各ターンがこの時間以内に終われば、制限時間に達せずにすべてのステージを実行できる見込みです。
+    /// 並列実行時は残り時間を全ワーカーで分け合うので、ワーカー数 (mStageStep) 倍のターン数で等分します。
+    ///
+    /// @return 1ターンに使ってよい時間の目安 (秒)。
+    double TimeBudget::turnAllowanceSec()const
+    {
+        const int turnCount = expectedRestTurnCount();
+        if (turnCount <= 0) {
+            return 0;
+        }
+        const double sec = restSec() - Parameter::GameTimeLimitSec * ReserveRate;
+        return 0.0 < sec ? sec / (static_cast<double>(turnCount) * mStageStep) : 0.0;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 探索を反復して深める回答は、反復の合間にこの関数で打ち切りを判断します。
+    ///
+    /// @pre 締め切りが有効 (isDeadlineEnabled) である必要があります。
+    ///
+    /// @return このターンの締め切り前であれば @c true を返します。
+    bool TimeBudget::isTurnInTime()const
+    {
+        HPC_ASSERT(mIsDeadlineEnabled);
+        return Profiler::NowSec() < mTurnEndSec;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 残り時間が制限時間の ReserveRate の割合以下になると、予備に入ったとみなします。
+    /// 各ターンの時間を決めずに探索する回答は、予備に入ったら探索をやめることで、
+    /// 制限時間を超えないようにします。
+    ///
+    /// @return 予備に入っている場合は @c true を返します。
+    bool TimeBudget::isInReserve()const
+    {
+        return restSec() <= Parameter::GameTimeLimitSec * ReserveRate;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 有効な場合、回答は isTurnInTime() で探索を打ち切ります。
+    /// 無効な場合、回答は探索の量を自分で決めます。
+    ///
+    /// @return 各ターンの締め切りを使う場合は @c true を返します。
+    bool TimeBudget::isDeadlineEnabled()const
+    {
+        return mIsDeadlineEnabled;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 規模あたりのターン数。実行し終えたステージが無ければ PriorTurnPerScale です。
+    float TimeBudget::turnPerScale()const
+    {
+        if (mDoneScale <= 0.0f) {
+            return PriorTurnPerScale;
+        }
+        return static_cast<float>(mDoneTurnCount) / mDoneScale;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aStageIndex ステージ番号。
+    ///
+    /// @return ステージを開始してから終了するまでのターン数の見積もり。
+    int TimeBudget::expectedTurnCount(int aStageIndex)const
+    {
+        const int turnCount = static_cast<int>(LevelDesigner::StageScale(aStageIndex) * turnPerScale()) + 1;
+        return Math::Min(turnCount, Parameter::GameTurnPerStage);
+    }
+
+    //------------------------------------------------------------------------------
+    /// 見積もりはステージの開始と終了のときにしか変わらないので、
+    /// ターンごとに計算し直さずに済むよう保持しておきます。
+    void TimeBudget::updateNextTurnCount()
+    {
+        mNextTurnCount = 0;
+        for (int stage = mStageIndex + mStageStep; stage < mStageEnd; stage += mStageStep) {
+            mNextTurnCount += expectedTurnCount(stage);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
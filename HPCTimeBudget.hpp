@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    TimeBudget クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    class Timer;
+
+    //------------------------------------------------------------------------------
+    /// ゲーム全体の制限時間のうち、残りの時間と残りの処理量の見積もりを提供します。
+    ///
+    /// 回答は StageAccessor::timeBudget() から参照し、探索などに使う時間を調整します。
+    ///
+    /// 1ターンに使ってよい時間は、残り時間を残りのターン数の見積もりで等分して求めます。
+    /// 残りのターン数は、ステージの規模 (LevelDesigner::StageScale) に比例すると仮定して見積もります。
+    /// 比例係数は、実行し終えたステージの実際のターン数から求めます。
+    ///
+    /// 既定では、回答は探索の量を自分で決め、 isInReserve() を制限時間に対する
+    /// 安全策としてだけ使います。この場合、結果は実行環境や並列数によらず同じになります。
+    ///
+    /// 締め切りを有効にした場合 (setDeadlineEnabled) は、各ターンの開始時に
+    /// turnAllowanceSec() の時間を締め切りとして確定させます。
+    /// 締め切りは高分解能の時計 (Profiler::NowSec) で計測するので、
+    /// 回答は isTurnInTime() を確認しながら、反復して探索を深めることができます。
+    /// ただし締め切りで探索を打ち切ると、結果が実行環境や並列数によって変わります。
+    class TimeBudget
+    {
+    public:
+        static const float PriorTurnPerScale;               ///< ステージを1つも終えていないときの、規模あたりのターン数
+        static const float ReserveRate;                     ///< 制限時間のうち、 turnAllowanceSec で配分せずに残しておく割合
+
+        TimeBudget();
+
+        /// @name ゲームからの通知
+        //@{
+        /// 計測するタイマーと、実行するステージを設定します。
+        void setup(
+            const Timer& aTimer
+            , int aStageBegin
+            , int aStageEnd
+            , int aStageStep
+            );
+        void startStage(int aStageIndex);                   ///< ステージの開始を通知します。
+        void setTurnIndex(int aTurnIndex);                  ///< 現在のターン番号を通知します。
+        void endStage();                                    ///< ステージの終了を通知します。
+        void setDeadlineEnabled(bool aIsEnabled);           ///< 各ターンの締め切りを使うかを設定します。
+        //@}
+
+        /// @name 回答から参照する値
+        //@{
+        bool isTurnInTime()const;                           ///< このターンに使える時間が残っているかを返します。
+        bool isInReserve()const;                            ///< 制限時間の予備に入ったかを返します。
+        bool isDeadlineEnabled()const;                      ///< 各ターンの締め切りを使うかを返します。
+        //@}
+
+    private:
+        const Timer* mTimer;        ///< ゲームの制限時間を計測するタイマー。設定されていなければ 0
+        int mStageEnd;              ///< 実行する最後のステージ番号 + 1
+        int mStageStep;             ///< 実行するステージ番号の間隔
+        int mStageIndex;            ///< 実行中のステージ番号。開始前は実行する最初のステージ番号
+        int mTurnIndex;             ///< 実行中のステージのターン番号
+        int mDoneTurnCount;         ///< 実行し終えたステージのターン数の合計
+        float mDoneScale;           ///< 実行し終えたステージの規模の合計
+        int mNextTurnCount;         ///< 実行中のステージより後のステージのターン数の見積もりの合計
+        double mTurnEndSec;         ///< このターンの締め切りの時刻 (Profiler::NowSec)
+        bool mIsDeadlineEnabled;    ///< 各ターンの締め切りを使うか
+
+        double restSec()const;                              ///< ゲーム全体の残り時間を返します。
+        int expectedRestTurnCount()const;                   ///< 実行中のステージを含む、残りのターン数の見積もりを返します。
+        int expectedStageRestTurnCount()const;              ///< 実行中のステージの、残りのターン数の見積もりを返します。
+        double turnAllowanceSec()const;                     ///< 1ターンに使ってよい時間の目安を返します。
+        float turnPerScale()const;                          ///< 規模あたりのターン数の見積もりを返します。
+        int expectedTurnCount(int aStageIndex)const;        ///< ステージ全体のターン数の見積もりを返します。
+        void updateNextTurnCount();                         ///< mNextTurnCount を更新します。
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
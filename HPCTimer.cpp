@@ -11,26 +11,49 @@
 
 #include "HPCTimer.hpp"
 
-namespace {
+#if defined(__unix__) || defined(__APPLE__)
+    #define HPC_TIMER_CLOCK_GETTIME
+    #include <time.h>
+#elif defined(_WIN32)
+    #define HPC_TIMER_GET_THREAD_TIMES
+    #include <windows.h>
+#endif
 
-    //------------------------------------------------------------------------------
-    /// 現在の時間を取得します。
-    ///
-    /// @return 現在の時刻を表す std::clock_t 型オブジェクト。
-    std::clock_t GetCurrentTime()
-    {
-        return ::std::clock();
-    }
+namespace {
 
     //------------------------------------------------------------------------------
-    /// std::clock_t で表される時間を秒に変換します。
+    /// 呼び出したスレッドが使用した CPU 時間を取得します。
     ///
-    /// @param[in] aTime std::clock_t 型で表される時間
+    /// プロセス全体の CPU 時間 (std::clock) ではなくスレッドの CPU 時間を使うので、
+    /// 1つのプロセスで複数のゲームをスレッドで同時に実行しても、
+    /// 各ゲームの時間は他のゲームの影響を受けません。
+    /// 1つのスレッドで実行する場合は std::clock と同じ値になります。
+    /// 対応する時計がない環境では std::clock を使用します。
     ///
-    /// @return aTime を秒に変換した値。
-    double ToSec(std::clock_t aTime)
+    /// @return 現在の CPU 時間 (秒)。
+    double GetCurrentSec()
     {
-        return static_cast<double>(aTime) / CLOCKS_PER_SEC;
+#if defined(HPC_TIMER_CLOCK_GETTIME)
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+#elif defined(HPC_TIMER_GET_THREAD_TIMES)
+        FILETIME creationTime;
+        FILETIME exitTime;
+        FILETIME kernelTime;
+        FILETIME userTime;
+        GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime);
+        ULARGE_INTEGER kernel;
+        ULARGE_INTEGER user;
+        kernel.LowPart = kernelTime.dwLowDateTime;
+        kernel.HighPart = kernelTime.dwHighDateTime;
+        user.LowPart = userTime.dwLowDateTime;
+        user.HighPart = userTime.dwHighDateTime;
+        // FILETIME は 100 ナノ秒単位
+        return static_cast<double>(kernel.QuadPart + user.QuadPart) * 1e-7;
+#else
+        return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
     }
 }
 
@@ -45,24 +68,65 @@ namespace hpc {
     /// @param[in] aLimitSec 制限時間を秒で指定。
     Timer::Timer(int aLimitSec)
         : mLimitSec(aLimitSec)
-        , mTimeBegin(std::clock_t())
+        , mBeginSec(0)
+        , mSharedPastSecs(0)
+        , mSharedCount(0)
+        , mSharedIndex(0)
     {
     }
 
+    //------------------------------------------------------------------------------
+    /// 経過時間を、他のタイマーの経過時間と合算するように設定します。
+    ///
+    /// 並列実行時に、各ワーカーのタイマーで1つの制限時間を分け合うために使います。
+    /// 他のタイマーの経過時間は、そのタイマーが最後に計測した時点の値になります。
+    ///
+    /// @param[in,out] aPastSecs 各タイマーの経過時間。ワーカー間で共有するメモリを指定します。
+    ///                          0 を指定すると、合算をやめます。
+    /// @param[in]     aCount    aPastSecs の要素数。
+    /// @param[in]     aIndex    aPastSecs のうち、このタイマーの経過時間を書き込む位置。
+    void Timer::share(double* aPastSecs, int aCount, int aIndex)
+    {
+        mSharedPastSecs = aPastSecs;
+        mSharedCount = aPastSecs ? aCount : 0;
+        mSharedIndex = aIndex;
+    }
+
     //------------------------------------------------------------------------------
     /// タイマーの計測を開始します。
     void Timer::start()
     {
-        mTimeBegin = GetCurrentTime();
+        mBeginSec = GetCurrentSec();
     }
 
     //------------------------------------------------------------------------------
     /// start 関数を呼び出した時点からの経過時間を取得します。
     ///
+    /// share を呼び出している場合は、このタイマーの経過時間を書き込んでから、
+    /// すべてのタイマーの経過時間を合計します。
+    ///
     /// @return start を呼び出してからの経過時間を秒に変換したもの。
     double Timer::pastSec()const
     {
-        return ToSec(GetCurrentTime() - mTimeBegin);
+        const double sec = ownPastSec();
+        if (!mSharedPastSecs) {
+            return sec;
+        }
+        mSharedPastSecs[mSharedIndex] = sec;
+        double total = 0;
+        for (int index = 0; index < mSharedCount; ++index) {
+            total += mSharedPastSecs[index];
+        }
+        return total;
+    }
+
+    //------------------------------------------------------------------------------
+    /// share で合算する他のタイマーの経過時間を含みません。
+    ///
+    /// @return start を呼び出してからの経過時間を秒に変換したもの。
+    double Timer::ownPastSec()const
+    {
+        return GetCurrentSec() - mBeginSec;
     }
 
     //------------------------------------------------------------------------------
@@ -80,6 +144,15 @@ namespace hpc {
         }
     }
 
+    //------------------------------------------------------------------------------
+    /// @return start を呼び出してから制限時間までの残り時間を秒に変換したもの。
+    ///         制限時間を超過した場合は 0 を返します。
+    double Timer::restSec()const
+    {
+        const double sec = mLimitSec - pastSec();
+        return 0.0 < sec ? sec : 0.0;
+    }
+
     //------------------------------------------------------------------------------
     /// @return 制限時間以内の場合 @c false を返し、
     ///         超過した場合は @c true を返します。
@@ -16,20 +16,33 @@ namespace hpc {
 
     //------------------------------------------------------------------------------
     /// 実時間計測を行うタイマーを提供します。
+    ///
+    /// 時間は start を呼び出したスレッドの CPU 時間で計ります。
+    /// 計測は start を呼び出したスレッドで行う必要があります。
+    ///
+    /// share を呼び出すと、複数のタイマーで1つの制限時間を分け合います。
+    /// 各タイマーは自分の経過時間を共有する配列に書き込み、
+    /// 配列の合計を経過時間とします。
     class Timer
     {
     public:
         Timer(int aLimitSec);               ///< 制限時間を定めてインスタンスを生成します。
 
+        void share(double* aPastSecs, int aCount, int aIndex);  ///< 経過時間を他のタイマーと合算するように設定します。
         void start();                       ///< タイマーを開始します。
         bool isInTime()const;              ///< 制限時間内かどうかを返します。
         double pastSecForPrint()const;     ///< 表示用の経過時間を取得します。
+        double restSec()const;             ///< 制限時間までの残り時間を取得します。
+        double ownPastSec()const;          ///< このタイマーだけの経過時間を取得します。
 
     private:
         double pastSec()const;             ///< 経過時間を取得します。
 
         const int mLimitSec;                ///< 制限時間
-        std::clock_t mTimeBegin;            ///< 開始時刻
+        double mBeginSec;                   ///< 開始時刻
+        double* mSharedPastSecs;            ///< 経過時間を合算するタイマーの経過時間
+        int mSharedCount;                   ///< 経過時間を合算するタイマーの数
+        int mSharedIndex;                   ///< mSharedPastSecs のうち、このタイマーの経過時間の位置
     };
 }
 //------------------------------------------------------------------------------
@@ -0,0 +1,182 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCTournament.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCTournament.hpp"
+
+#include <cstring>
+#include "HPCCommon.hpp"
+#include "HPCRandomSeed.hpp"
+#include "HPCRecordSink.hpp"
+#include "HPCSimulation.hpp"
+#include "HPCStrategy.hpp"
+#include "HPCStrategyRegistry.hpp"
+
+namespace {
+    using namespace hpc;
+
+    /// 戦略の名前として読める最大の長さ
+    const int NameLengthMax = 31;
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 参加する戦略がない状態でインスタンスを生成します。
+    Tournament::Tournament()
+        : mEntries()
+        , mEntryCount(0)
+        , mStageBegin(0)
+        , mStageEnd(0)
+        , mScores()
+        , mPastSec()
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aNamesStr "answer,cpu" のような、カンマ区切りの戦略の名前。
+    ///
+    /// @return すべての名前が登録されている戦略で、数が EntryCountMax 以下の場合は
+    ///         @c true を返します。
+    bool Tournament::setupEntries(const char* aNamesStr)
+    {
+        mEntryCount = 0;
+        const char* str = aNamesStr;
+        while (true) {
+            const char* end = std::strchr(str, ',');
+            const int length = end ? static_cast<int>(end - str) : static_cast<int>(std::strlen(str));
+            if (length <= 0 || NameLengthMax < length || EntryCountMax <= mEntryCount) {
+                return false;
+            }
+            char name[NameLengthMax + 1];
+            std::memcpy(name, str, length);
+            name[length] = '\0';
+            const Strategy* strategy = StrategyRegistry::Find(name);
+            if (!strategy) {
+                return false;
+            }
+            mEntries[mEntryCount] = strategy;
+            ++mEntryCount;
+            if (!end) {
+                return true;
+            }
+            str = end + 1;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return setupEntries で設定した戦略の数。
+    int Tournament::entryCount()const
+    {
+        return mEntryCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex 戦略の番号。 [0, entryCount()) の範囲で指定します。
+    ///
+    /// @return aIndex 番目の戦略。
+    const Strategy& Tournament::entry(int aIndex)const
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, mEntryCount);
+        return *mEntries[aIndex];
+    }
+
+    //------------------------------------------------------------------------------
+    /// 戦略ごとに aSim の状態を既定のシードに戻して実行します。
+    /// 実行後の aSim の戦略は、最後に実行した戦略のままです。
+    ///
+    /// @param[in,out] aSim         ゲームの実行に使う Simulation 。
+    /// @param[in]     aWorkerCount ワーカー数。0 を指定した場合は利用可能なコア数になります。
+    void Tournament::run(Simulation& aSim, int aWorkerCount)
+    {
+        HPC_LB_ASSERT_I(mEntryCount, 0);
+
+        mStageBegin = aSim.stageBegin();
+        mStageEnd = aSim.stageEnd();
+
+        // 得点の比較には各ターンの内容は不要なので、記録しない
+        RecordSink nullSink;
+        aSim.setRecordSink(&nullSink);
+
+        for (int entry = 0; entry < mEntryCount; ++entry) {
+            if (!aSim.setPlayerStrategy(*mEntries[entry])) {
+                HPC_PRINT("Failed to set up %s.\n", mEntries[entry]->name);
+                continue;
+            }
+            aSim.reset(RandomSeed());
+            aSim.run(aWorkerCount);
+            for (int stage = 0; stage < Parameter::GameStageCount; ++stage) {
+                mScores[entry][stage] = aSim.record().stage(stage).score();
+            }
+            mPastSec[entry] = aSim.pastSec();
+        }
+        aSim.setRecordSink(0);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージごとの得点を戦略ごとの列に並べて表示し、最後に合計得点と、
+    /// 単独で最高得点だったステージの数 (Wins) を表示します。
+    void Tournament::outputResult()const
+    {
+        HPC_PRINT("Done.\n");
+        HPC_PRINT("%8s:%8d - %d\n", "Stages", mStageBegin, mStageEnd - 1);
+
+        int wins[EntryCountMax] = {};
+        double totals[EntryCountMax] = {};
+
+        HPC_PRINT("\n%8s", "Stage");
+        for (int entry = 0; entry < mEntryCount; ++entry) {
+            HPC_PRINT(" %12s", mEntries[entry]->name);
+        }
+        HPC_PRINT(" %12s\n", "Best");
+        for (int stage = mStageBegin; stage < mStageEnd; ++stage) {
+            HPC_PRINT("%8d", stage);
+            int best = 0;
+            bool isTied = false;
+            for (int entry = 0; entry < mEntryCount; ++entry) {
+                const double score = mScores[entry][stage];
+                HPC_PRINT(" %12.2f", score);
+                totals[entry] += score;
+                if (mScores[best][stage] < score) {
+                    best = entry;
+                    isTied = false;
+                }
+                else if (entry != best && score == mScores[best][stage]) {
+                    isTied = true;
+                }
+            }
+            if (isTied) {
+                HPC_PRINT(" %12s\n", "-");
+            }
+            else {
+                ++wins[best];
+                HPC_PRINT(" %12s\n", mEntries[best]->name);
+            }
+        }
+
+        HPC_PRINT("\n%8s", "Score");
+        for (int entry = 0; entry < mEntryCount; ++entry) {
+            // Record::score と同じく、合計してから整数に丸める
+            HPC_PRINT(" %12d", static_cast<int>(totals[entry]));
+        }
+        HPC_PRINT("\n%8s", "Wins");
+        for (int entry = 0; entry < mEntryCount; ++entry) {
+            HPC_PRINT(" %12d", wins[entry]);
+        }
+        HPC_PRINT("\n%8s", "Time");
+        for (int entry = 0; entry < mEntryCount; ++entry) {
+            HPC_PRINT(" %12.4f", mPastSec[entry]);
+        }
+        HPC_PRINT("\n");
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
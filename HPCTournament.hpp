@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Tournament クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "HPCParameter.hpp"
+
+namespace hpc {
+
+    class Simulation;
+    struct Strategy;
+
+    //------------------------------------------------------------------------------
+    /// 複数の戦略で同じステージを実行し、ステージごとの得点を比較します。
+    ///
+    /// 各戦略は同じシードで順番に実行するので、どの戦略も同じ配置のステージを遊びます。
+    /// 1つの戦略の中では、ステージを複数のワーカーで並列に実行できます。
+    class Tournament
+    {
+    public:
+        static const int EntryCountMax = 8;             ///< 参加できる戦略の最大数
+
+        Tournament();
+
+        bool setupEntries(const char* aNamesStr);       ///< 参加する戦略をカンマ区切りの名前で設定します。
+        int entryCount()const;                          ///< 参加する戦略の数を返します。
+        const Strategy& entry(int aIndex)const;         ///< 参加する戦略を返します。
+
+        void run(Simulation& aSim, int aWorkerCount);   ///< すべての戦略でゲームを実行します。
+        void outputResult()const;                       ///< 比較結果を表示します。
+
+    private:
+        const Strategy* mEntries[EntryCountMax];        ///< 参加する戦略
+        int mEntryCount;                                ///< 参加する戦略の数
+        int mStageBegin;                                ///< 実行した最初のステージ番号
+        int mStageEnd;                                  ///< 実行した最後のステージ番号 + 1
+        double mScores[EntryCountMax][Parameter::GameStageCount]; ///< 各戦略のステージごとの得点
+        double mPastSec[EntryCountMax];                 ///< 各戦略の実行に掛かった時間
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
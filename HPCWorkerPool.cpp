@@ -0,0 +1,266 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCWorkerPool.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCWorkerPool.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "HPCCommon.hpp"
+#include "HPCMath.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define HPC_WORKER_POOL_FORK
+    #include <sys/mman.h>
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+    #define HPC_WORKER_POOL_PTHREAD
+    #include <pthread.h>
+#endif
+
+namespace {
+    using namespace hpc;
+
+    /// スレッドとして起動したワーカーに渡すデータ
+    struct ThreadArg
+    {
+        WorkerPool::WorkerFunc func;
+        int workerIndex;
+        int workerCount;
+        void* userData;
+    };
+
+#ifdef HPC_WORKER_POOL_PTHREAD
+    //------------------------------------------------------------------------------
+    /// スレッドの開始関数として、ワーカーの関数を実行します。
+    void* RunThread(void* aArg)
+    {
+        const ThreadArg* arg = static_cast<const ThreadArg*>(aArg);
+        arg->func(arg->workerIndex, arg->workerCount, arg->userData);
+        return 0;
+    }
+#endif
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// @return 子プロセスによる並列実行が可能な場合は @c true を返します。
+    bool WorkerPool::IsSupported()
+    {
+#ifdef HPC_WORKER_POOL_FORK
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 利用可能なコア数。取得できない場合は 1 を返します。
+    int WorkerPool::CoreCount()
+    {
+#ifdef HPC_WORKER_POOL_FORK
+        const long count = sysconf(_SC_NPROCESSORS_ONLN);
+        if (0 < count) {
+            return Math::Min(static_cast<int>(count), WorkerCountMax);
+        }
+#endif
+        return 1;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 指定されたワーカー数を、実際に使用できるワーカー数に補正します。
+    ///
+    /// @param[in] aWorkerCount 希望するワーカー数。0 以下の場合はコア数を使用します。
+    ///
+    /// @return 実際に使用するワーカー数。並列実行に対応していない場合は 1 です。
+    int WorkerPool::ValidWorkerCount(int aWorkerCount)
+    {
+        if (!IsSupported()) {
+            return 1;
+        }
+        if (aWorkerCount <= 0) {
+            return CoreCount();
+        }
+        return Math::Min(aWorkerCount, WorkerCountMax);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ワーカー間で共有するメモリを確保します。
+    /// 確保したメモリはゼロで初期化されています。
+    ///
+    /// @param[in] aSize 確保するバイト数。
+    ///
+    /// @return 確保したメモリの先頭。確保に失敗した場合は 0 を返します。
+    void* WorkerPool::AllocShared(int aSize)
+    {
+        HPC_LB_ASSERT_I(aSize, 0);
+#ifdef HPC_WORKER_POOL_FORK
+        void* ptr = mmap(0, aSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        return ptr == MAP_FAILED ? 0 : ptr;
+#else
+        return std::calloc(1, aSize);
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// AllocShared で確保したメモリを解放します。
+    ///
+    /// @param[in] aPtr  AllocShared で確保したメモリの先頭。
+    /// @param[in] aSize AllocShared に渡したバイト数。
+    void WorkerPool::FreeShared(void* aPtr, int aSize)
+    {
+        if (!aPtr) {
+            return;
+        }
+#ifdef HPC_WORKER_POOL_FORK
+        munmap(aPtr, aSize);
+#else
+        std::free(aPtr);
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// aWorkerCount 個のワーカーを起動し、すべてのワーカーが終了するまで待ちます。
+    ///
+    /// @note ワーカーで行った変更のうち、呼び出し元に反映されるのは
+    ///       共有メモリに書き込んだ内容のみです。
+    ///       子プロセスを起動できなかったワーカーは呼び出し元のプロセスで実行するので、
+    ///       aFunc は呼び出し元で実行されても結果が変わらないようにする必要があります。
+    ///
+    /// @param[in] aWorkerCount ワーカー数。 ValidWorkerCount で補正された値を指定します。
+    /// @param[in] aFunc        各ワーカーで実行する関数。
+    /// @param[in] aUserData    aFunc に渡されるユーザーデータ。
+    ///
+    /// @return すべてのワーカーが正常に終了した場合は @c true を返します。
+    bool WorkerPool::Run(int aWorkerCount, WorkerFunc aFunc, void* aUserData)
+    {
+        HPC_RANGE_ASSERT_MIN_MAX_I(aWorkerCount, 1, WorkerCountMax);
+#ifdef HPC_WORKER_POOL_FORK
+        if (aWorkerCount == 1) {
+            aFunc(0, 1, aUserData);
+            return true;
+        }
+
+        // バッファの内容が子プロセスで二重に出力されないようにする
+        std::fflush(stdout);
+        std::fflush(stderr);
+
+        pid_t pids[WorkerCountMax];
+        int startedCount = 0;
+        for (; startedCount < aWorkerCount; ++startedCount) {
+            const pid_t pid = fork();
+            if (pid < 0) {
+                HPC_PRINT("fork failed: %s\n", std::strerror(errno));
+                break;
+            }
+            if (pid == 0) {
+                aFunc(startedCount, aWorkerCount, aUserData);
+                std::fflush(stdout);
+                std::fflush(stderr);
+                _exit(0);
+            }
+            pids[startedCount] = pid;
+        }
+
+        // 起動できなかったワーカーの処理は、呼び出し元のプロセスで順番に実行する
+        for (int index = startedCount; index < aWorkerCount; ++index) {
+            aFunc(index, aWorkerCount, aUserData);
+        }
+
+        bool isSucceeded = true;
+        for (int index = 0; index < startedCount; ++index) {
+            int status = 0;
+            while (waitpid(pids[index], &status, 0) < 0) {
+                if (errno != EINTR) {
+                    status = -1;
+                    break;
+                }
+            }
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                HPC_PRINT("Worker #%d terminated abnormally.\n", index);
+                isSucceeded = false;
+            }
+        }
+        return isSucceeded;
+#else
+        for (int index = 0; index < aWorkerCount; ++index) {
+            aFunc(index, aWorkerCount, aUserData);
+        }
+        return true;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return スレッドによる並列実行が可能な場合は @c true を返します。
+    bool WorkerPool::IsThreadSupported()
+    {
+#ifdef HPC_WORKER_POOL_PTHREAD
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /// aWorkerCount 個のワーカーをスレッドとして起動し、すべてのワーカーが終了するまで待ちます。
+    ///
+    /// Run と異なり、ワーカーは呼び出し元とメモリを共有するので、
+    /// aUserData を通して結果を直接書き込めます。
+    /// 複数のワーカーから同じオブジェクトを変更しないようにする必要があります。
+    ///
+    /// @param[in] aWorkerCount ワーカー数。 ValidWorkerCount で補正された値を指定します。
+    /// @param[in] aFunc        各ワーカーで実行する関数。
+    /// @param[in] aUserData    aFunc に渡されるユーザーデータ。
+    ///
+    /// @return すべてのワーカーを起動できた場合は @c true を返します。
+    bool WorkerPool::RunThreads(int aWorkerCount, WorkerFunc aFunc, void* aUserData)
+    {
+        HPC_RANGE_ASSERT_MIN_MAX_I(aWorkerCount, 1, WorkerCountMax);
+#ifdef HPC_WORKER_POOL_PTHREAD
+        if (aWorkerCount == 1) {
+            aFunc(0, 1, aUserData);
+            return true;
+        }
+
+        pthread_t threads[WorkerCountMax];
+        ThreadArg args[WorkerCountMax];
+        int startedCount = 0;
+        for (; startedCount < aWorkerCount; ++startedCount) {
+            ThreadArg& arg = args[startedCount];
+            arg.func = aFunc;
+            arg.workerIndex = startedCount;
+            arg.workerCount = aWorkerCount;
+            arg.userData = aUserData;
+            const int error = pthread_create(&threads[startedCount], 0, &RunThread, &arg);
+            if (error != 0) {
+                HPC_PRINT("pthread_create failed: %s\n", std::strerror(error));
+                break;
+            }
+        }
+
+        for (int index = 0; index < startedCount; ++index) {
+            pthread_join(threads[index], 0);
+        }
+        return startedCount == aWorkerCount;
+#else
+        for (int index = 0; index < aWorkerCount; ++index) {
+            aFunc(index, aWorkerCount, aUserData);
+        }
+        return true;
+#endif
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
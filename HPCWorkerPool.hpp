@@ -0,0 +1,56 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    WorkerPool クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 複数のワーカーで処理を並列に実行する機能を提供します。
+    ///
+    /// 各ワーカーは子プロセスとして実行されるため、 Answer.cpp の
+    /// グローバル変数などの状態はワーカー同士で共有されません。
+    /// 結果は AllocShared で確保した共有メモリを介して受け渡します。
+    ///
+    /// プロセスの生成に対応していない環境では、すべての処理を
+    /// 呼び出し元のプロセスで順番に実行します。
+    ///
+    /// RunThreads は、ワーカーを子プロセスの代わりに同じプロセスのスレッドとして実行します。
+    /// プロセスを生成する負荷がなく、メモリを共有しますが、各ワーカーは
+    /// グローバル変数を使わずに、それぞれ別の Simulation などの状態を使う必要があります。
+    class WorkerPool
+    {
+    public:
+        static const int WorkerCountMax = 256;              ///< 同時に起動するワーカー数の上限
+
+        /// ワーカーで実行する関数の型
+        ///
+        /// @param[in] aWorkerIndex ワーカー番号。[0, aWorkerCount) の範囲になります。
+        /// @param[in] aWorkerCount ワーカー数。
+        /// @param[in] aUserData    Run に渡されたユーザーデータ。
+        typedef void (*WorkerFunc)(int aWorkerIndex, int aWorkerCount, void* aUserData);
+
+        static bool IsSupported();                          ///< 並列実行に対応しているかを返します。
+        static int CoreCount();                             ///< 利用可能なコア数を返します。
+        static int ValidWorkerCount(int aWorkerCount);      ///< 実際に使用するワーカー数を返します。
+        static void* AllocShared(int aSize);                ///< ワーカー間で共有するメモリを確保します。
+        static void FreeShared(void* aPtr, int aSize);      ///< 共有メモリを解放します。
+        /// ワーカーを起動し、すべて終了するまで待ちます。
+        static bool Run(int aWorkerCount, WorkerFunc aFunc, void* aUserData);
+        static bool IsThreadSupported();                    ///< スレッドでの並列実行に対応しているかを返します。
+        /// ワーカーをスレッドとして起動し、すべて終了するまで待ちます。
+        static bool RunThreads(int aWorkerCount, WorkerFunc aFunc, void* aUserData);
+
+    private:
+        WorkerPool();
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
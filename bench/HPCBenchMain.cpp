@@ -0,0 +1,362 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    ベンチマーク用の main 関数
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "HPCAction.hpp"
+#include "HPCBenchmark.hpp"
+#include "HPCBrain.hpp"
+#include "HPCChara.hpp"
+#include "HPCCircle.hpp"
+#include "HPCCollision.hpp"
+#include "HPCCommon.hpp"
+#include "HPCJsonWriter.hpp"
+#include "HPCLevelDesigner.hpp"
+#include "HPCMath.hpp"
+#include "HPCMoveKernel.hpp"
+#include "HPCRandomSet.hpp"
+#include "HPCRecord.hpp"
+#include "HPCStage.hpp"
+#include "HPCStageAccessor.hpp"
+#include "HPCStageSnapshot.hpp"
+#include "HPCVec2.hpp"
+
+//------------------------------------------------------------------------------
+namespace {
+    using namespace hpc;
+
+    /// ベンチマークに使うステージ番号
+    const int BenchStageIndex = 0;
+    /// Vec2 や Collision の計測に使う値の数
+    const int SampleCount = 1024;
+
+    /// 各計測で共有するデータ
+    struct BenchData
+    {
+        RandomSet randomSet;                    ///< ステージ生成用の乱数
+        Stage stage;                            ///< 計測に使うステージ
+        StageSnapshot snapshot;                 ///< ステージの開始状態
+        Record record;                          ///< ターンの記録先
+        Vec2 vecs[SampleCount];                 ///< ランダムなベクトル
+        Vec2 circlePos[SampleCount];            ///< ランダムな円の中心座標
+        float circleRadius[SampleCount];        ///< ランダムな円の半径
+        Vec2 movePos[SampleCount];              ///< MoveKernel で動かす位置
+        Vec2 moveVel[SampleCount];              ///< MoveKernel で動かす速度
+        int stageNumber;                        ///< LevelDesigner::Setup で次に生成するステージ番号
+        /// 解答の状態の領域。 Game と同じく double の配列で持ちます
+        double answerState[StageAccessor::AnswerStateSize / sizeof(double)];
+    };
+
+    // 大きいので static な変数として用意します。
+    BenchData sData;
+    // JsonWriter はバッファを持つので、同じく static な変数として用意します。
+    std::FILE* sJsonFile = 0;
+
+    //------------------------------------------------------------------------------
+    /// ステージを生成し、 CPU と同じ動きで最後まで進めて記録します。
+    /// 記録はステージ番号 BenchStageIndex の位置に残ります。
+    void SetupData()
+    {
+        BenchData& data = sData;
+        Random random(0x1234u, 0x5678u);
+        for (int index = 0; index < SampleCount; ++index) {
+            data.vecs[index] = Vec2(
+                random.randMinMax(-1000, 1000) * 0.01f
+                , random.randMinMax(-1000, 1000) * 0.01f
+                );
+            data.circlePos[index] = Vec2(
+                random.randMinMax(0, 1000) * 0.01f
+                , random.randMinMax(0, 1000) * 0.01f
+                );
+            data.circleRadius[index] = random.randMinMax(50, 200) * 0.01f;
+        }
+        data.stageNumber = 0;
+
+        // Stage::start で Answer::Init が呼ばれるので、先に解答の状態の領域を設定します。
+        data.stage.setAnswerState(data.answerState);
+        data.randomSet.setupStage(BenchStageIndex);
+        LevelDesigner::Setup(BenchStageIndex, data.stage, data.randomSet.system());
+        data.stage.start();
+        data.stage.save(data.snapshot, data.randomSet.game());
+
+        // 全キャラを CPU と同じ方針で動かします。
+        data.record.setupTurnBuffer();
+        data.record.writeStartStage(BenchStageIndex, data.stage);
+        data.record.writeTurn(data.stage.lastTurnResult());
+        int saveAccelTurns[Parameter::CharaCountMax] = {};
+        Action actions[Parameter::CharaCountMax];
+        while (data.stage.lastTurnResult().state == StageState_Playing) {
+            const CharaCollection& charas = data.stage.charas();
+            for (int index = 0; index < charas.count(); ++index) {
+                const Chara& chara = charas[index];
+                actions[index] = chara.isGoal() ? Action::Wait() : Brain::CpuNextAction(
+                    chara.pos()
+                    , chara.accelCount()
+                    , data.stage.lotuses()[chara.targetLotusNo()].pos()
+                    , saveAccelTurns[index]
+                    , data.randomSet.game()
+                    );
+            }
+            data.stage.stepWith(actions);
+            data.record.writeTurn(data.stage.lastTurnResult());
+        }
+        data.record.writeEndStage(data.stage);
+    }
+
+    //------------------------------------------------------------------------------
+    /// ステージを開始直後の状態に戻します。
+    void RestoreStage(void*)
+    {
+        sData.stage.restore(sData.snapshot, sData.randomSet.game());
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchVec2Arith(void*, int aIterationCount)
+    {
+        Vec2 sum;
+        for (int count = 0; count < aIterationCount; ++count) {
+            const Vec2& lhs = sData.vecs[count % SampleCount];
+            const Vec2& rhs = sData.vecs[(count + 1) % SampleCount];
+            sum += (lhs - rhs) * 0.5f + rhs;
+        }
+        Benchmark::Consume(sum.x + sum.y);
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchVec2Length(void*, int aIterationCount)
+    {
+        float sum = 0.0f;
+        for (int count = 0; count < aIterationCount; ++count) {
+            sum += sData.vecs[count % SampleCount].length();
+        }
+        Benchmark::Consume(sum);
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchVec2Normalize(void*, int aIterationCount)
+    {
+        Vec2 sum;
+        for (int count = 0; count < aIterationCount; ++count) {
+            const Vec2& vec = sData.vecs[count % SampleCount];
+            if (!vec.isZero()) {
+                sum += vec.getNormalized(Parameter::CharaAccelSpeed());
+            }
+        }
+        Benchmark::Consume(sum.x + sum.y);
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchVec2Rotate(void*, int aIterationCount)
+    {
+        Vec2 sum;
+        for (int count = 0; count < aIterationCount; ++count) {
+            sum += sData.vecs[count % SampleCount].getRotated(Math::DegToRad(static_cast<float>(count % 40 - 20)));
+        }
+        Benchmark::Consume(sum.x + sum.y);
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchCollisionStatic(void*, int aIterationCount)
+    {
+        int hitCount = 0;
+        for (int count = 0; count < aIterationCount; ++count) {
+            const int index0 = count % SampleCount;
+            const int index1 = (count + 7) % SampleCount;
+            const Circle circle0(sData.circlePos[index0], sData.circleRadius[index0]);
+            const Circle circle1(sData.circlePos[index1], sData.circleRadius[index1]);
+            if (Collision::IsHit(circle0, circle1)) {
+                ++hitCount;
+            }
+        }
+        Benchmark::Consume(static_cast<float>(hitCount));
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchCollisionSwept(void*, int aIterationCount)
+    {
+        int hitCount = 0;
+        for (int count = 0; count < aIterationCount; ++count) {
+            const int index0 = count % SampleCount;
+            const int index1 = (count + 7) % SampleCount;
+            const Circle circle0(sData.circlePos[index0], sData.circleRadius[index0]);
+            const Circle moving(sData.circlePos[index1], sData.circleRadius[index1]);
+            const Vec2 destPos = moving.pos() + sData.vecs[index0] * 0.1f;
+            if (Collision::IsHit(circle0, moving, destPos)) {
+                ++hitCount;
+            }
+        }
+        Benchmark::Consume(static_cast<float>(hitCount));
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchCharaMove(void*, int aIterationCount)
+    {
+        CharaCollection& charas = sData.stage.charas();
+        for (int count = 0; count < aIterationCount; ++count) {
+            charas[count % charas.count()].move();
+        }
+        Benchmark::Consume(charas[0].pos().x);
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchCheckColl(void*, int aIterationCount)
+    {
+        CharaCollection& charas = sData.stage.charas();
+        for (int count = 0; count < aIterationCount; ++count) {
+            charas.procCheckColl(sData.stage);
+        }
+        Benchmark::Consume(charas[0].pos().x);
+    }
+
+    //------------------------------------------------------------------------------
+    /// MoveKernel で動かす位置と速度を初期値に戻します。
+    void RestoreMoveSamples(void*)
+    {
+        for (int index = 0; index < SampleCount; ++index) {
+            sData.movePos[index] = sData.circlePos[index];
+            sData.moveVel[index] = sData.vecs[index];
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchMoveKernel(void*, int aIterationCount)
+    {
+        const Vec2 flowVel = sData.stage.field().flowVel();
+        for (int count = 0; count < aIterationCount; ++count) {
+            const int index = count * Parameter::CharaCountMax % SampleCount;
+            MoveKernel::Move(&sData.movePos[index], &sData.moveVel[index], Parameter::CharaCountMax, flowVel);
+        }
+        Benchmark::Consume(sData.movePos[0].x);
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchLevelDesignerSetup(void*, int aIterationCount)
+    {
+        for (int count = 0; count < aIterationCount; ++count) {
+            sData.randomSet.setupStage(sData.stageNumber);
+            LevelDesigner::Setup(sData.stageNumber, sData.stage, sData.randomSet.system());
+            sData.stageNumber = (sData.stageNumber + 1) % Parameter::GameStageCount;
+        }
+        Benchmark::Consume(static_cast<float>(sData.stage.lotuses().count()));
+    }
+
+    //------------------------------------------------------------------------------
+    /// 記録に使っていないステージ番号で、記録を開始し直します。
+    void RestartRecord(void*)
+    {
+        sData.record.writeStartStage(BenchStageIndex + 1, sData.stage);
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchRecordWriteTurn(void*, int aIterationCount)
+    {
+        const TurnResult& result = sData.stage.lastTurnResult();
+        for (int count = 0; count < aIterationCount; ++count) {
+            sData.record.writeTurn(result);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    void BenchRecordStageDumpJson(void*, int aIterationCount)
+    {
+        static JsonWriter writer(sJsonFile, true);
+        for (int count = 0; count < aIterationCount; ++count) {
+            std::rewind(sJsonFile);
+            sData.record.stage(BenchStageIndex).dumpJson(writer);
+            writer.flush();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// ベンチマークのエントリポイントです。
+///
+/// @return プログラムが正常に終了したら 0 を返します。
+///
+/// @note 起動時引数を設定することで、挙動を変更することができます。
+///
+///   オプション | 説明
+///  ------------|----------------------------------------------
+///   -o FILE    | 計測結果を JSON で FILE に出力します。
+///   -r N       | 各処理を N 回計測し、中央値を求めます。
+///   -W N       | 計測前に N 回空実行します。
+///
+int main(int argc, const char* argv[])
+{
+    using namespace hpc;
+
+    const char* outputPath = 0;
+    Benchmark benchmark;
+    for (int index = 1; index < argc; ++index) {
+        const char* arg = argv[index];
+        if (index + 1 >= argc) {
+            HPC_PRINT("Invalid Argument: %s requires a value.\n", arg);
+            return 1;
+        }
+        const char* value = argv[++index];
+        if (!std::strcmp(arg, "-o")) {
+            outputPath = value;
+        }
+        else if (!std::strcmp(arg, "-r")) {
+            const int repeatCount = std::atoi(value);
+            if (repeatCount < 1 || Benchmark::RepeatCountMax < repeatCount) {
+                HPC_PRINT("Invalid Argument: -r must be in [1, %d].\n", Benchmark::RepeatCountMax);
+                return 1;
+            }
+            benchmark.setRepeatCount(repeatCount);
+        }
+        else if (!std::strcmp(arg, "-W")) {
+            const int warmupCount = std::atoi(value);
+            if (warmupCount < 0 || Benchmark::RepeatCountMax < warmupCount) {
+                HPC_PRINT("Invalid Argument: -W must be in [0, %d].\n", Benchmark::RepeatCountMax);
+                return 1;
+            }
+            benchmark.setWarmupCount(warmupCount);
+        }
+        else {
+            HPC_PRINT("Invalid Argument: %s is unknown command.\n", arg);
+            return 1;
+        }
+    }
+
+    sJsonFile = std::tmpfile();
+    if (!sJsonFile) {
+        HPC_PRINT("Failed to open a temporary file.\n");
+        return 1;
+    }
+    SetupData();
+
+    benchmark.run("Vec2.arith", BenchVec2Arith, 0, 0, 100000);
+    benchmark.run("Vec2.length", BenchVec2Length, 0, 0, 100000);
+    benchmark.run("Vec2.getNormalized", BenchVec2Normalize, 0, 0, 100000);
+    benchmark.run("Vec2.getRotated", BenchVec2Rotate, 0, 0, 100000);
+    benchmark.run("Collision.IsHit.static", BenchCollisionStatic, 0, 0, 100000);
+    benchmark.run("Collision.IsHit.swept", BenchCollisionSwept, 0, 0, 100000);
+    benchmark.run("Chara.move", BenchCharaMove, RestoreStage, 0, 100000);
+    benchmark.run("CharaCollection.procCheckColl", BenchCheckColl, RestoreStage, 0, 10000);
+    benchmark.run("MoveKernel.Move", BenchMoveKernel, RestoreMoveSamples, 0, 10000);
+    benchmark.run("LevelDesigner.Setup", BenchLevelDesignerSetup, 0, 0, Parameter::GameStageCount);
+    benchmark.run("Record.writeTurn", BenchRecordWriteTurn, RestartRecord, 0, Parameter::GameTurnPerStage);
+    benchmark.run("RecordStage.dumpJson", BenchRecordStageDumpJson, 0, 0, 1);
+
+    benchmark.print();
+    std::fclose(sJsonFile);
+
+    if (outputPath && !benchmark.writeJson(outputPath)) {
+        HPC_PRINT("Failed to write %s.\n", outputPath);
+        return 1;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// EOF
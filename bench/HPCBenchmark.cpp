@@ -0,0 +1,208 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    HPCBenchmark.hpp の実装
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+
+#include "HPCBenchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "HPCCommon.hpp"
+#include "HPCJsonWriter.hpp"
+#include "HPCProfiler.hpp"
+
+namespace {
+    using namespace hpc;
+
+    const int DefaultWarmupCount = 3;
+    const int DefaultRepeatCount = 15;
+
+    /// Consume で書き込む先。 volatile なので書き込みは省略されません。
+    volatile float sConsumed = 0.0f;
+
+    //------------------------------------------------------------------------------
+    /// @param[in,out] aValues 値の配列。並べ替えられます。
+    /// @param[in]     aCount  値の数。
+    ///
+    /// @return 中央値
+    double Median(double* aValues, int aCount)
+    {
+        HPC_LB_ASSERT_I(aCount, 0);
+        std::sort(aValues, aValues + aCount);
+        const int half = aCount / 2;
+        if (aCount % 2 == 1) {
+            return aValues[half];
+        }
+        return (aValues[half - 1] + aValues[half]) * 0.5;
+    }
+}
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 計測結果を持たない状態でインスタンスを生成します。
+    Benchmark::Benchmark()
+        : mResults()
+        , mResultCount(0)
+        , mWarmupCount(DefaultWarmupCount)
+        , mRepeatCount(DefaultRepeatCount)
+    {
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aWarmupCount 計測前に空実行する回数。
+    void Benchmark::setWarmupCount(int aWarmupCount)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aWarmupCount, 0, RepeatCountMax + 1);
+        mWarmupCount = aWarmupCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aRepeatCount 1つの処理を計測する回数。 [1, RepeatCountMax] の範囲で指定します。
+    void Benchmark::setRepeatCount(int aRepeatCount)
+    {
+        HPC_RANGE_ASSERT_MIN_MAX_I(aRepeatCount, 1, RepeatCountMax);
+        mRepeatCount = aRepeatCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// aSetupFunc と aFunc の組を、ウォームアップの回数と計測の回数だけ実行します。
+    /// 時間を計るのは aFunc だけです。
+    ///
+    /// @param[in] aName           処理の名前。結果に表示されるので、文字列は保持しておく必要があります。
+    /// @param[in] aFunc           計測する処理。
+    /// @param[in] aSetupFunc      計測の前に毎回呼ばれる準備処理。不要な場合は 0 を指定します。
+    /// @param[in] aUserData       aFunc と aSetupFunc に渡されるユーザーデータ。
+    /// @param[in] aIterationCount 1回の計測で aFunc に渡す繰り返し回数。
+    void Benchmark::run(
+        const char* aName
+        , CaseFunc aFunc
+        , SetupFunc aSetupFunc
+        , void* aUserData
+        , int aIterationCount
+        )
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(mResultCount, 0, CaseCountMax);
+        HPC_LB_ASSERT_I(aIterationCount, 0);
+
+        for (int count = 0; count < mWarmupCount; ++count) {
+            if (aSetupFunc) {
+                aSetupFunc(aUserData);
+            }
+            aFunc(aUserData, aIterationCount);
+        }
+
+        double nsList[RepeatCountMax];
+        for (int count = 0; count < mRepeatCount; ++count) {
+            if (aSetupFunc) {
+                aSetupFunc(aUserData);
+            }
+            const double beginSec = Profiler::NowSec();
+            aFunc(aUserData, aIterationCount);
+            const double endSec = Profiler::NowSec();
+            nsList[count] = (endSec - beginSec) * 1.0e9 / aIterationCount;
+        }
+
+        Result& result = mResults[mResultCount];
+        result.name = aName;
+        result.iterationCount = aIterationCount;
+        result.repeatCount = mRepeatCount;
+        result.medianNs = Median(nsList, mRepeatCount);
+        result.minNs = nsList[0];
+        for (int count = 0; count < mRepeatCount; ++count) {
+            nsList[count] = std::fabs(nsList[count] - result.medianNs);
+        }
+        result.madNs = Median(nsList, mRepeatCount);
+        ++mResultCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @return 計測した処理の数。
+    int Benchmark::resultCount()const
+    {
+        return mResultCount;
+    }
+
+    //------------------------------------------------------------------------------
+    /// @param[in] aIndex 計測した順番。
+    ///
+    /// @return 計測結果。
+    const Benchmark::Result& Benchmark::result(int aIndex)const
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, mResultCount);
+        return mResults[aIndex];
+    }
+
+    //------------------------------------------------------------------------------
+    void Benchmark::print()const
+    {
+        HPC_PRINT("%-32s %12s %10s %12s %10s\n", "Case", "median(ns)", "MAD(ns)", "min(ns)", "iter");
+        for (int index = 0; index < mResultCount; ++index) {
+            const Result& result = mResults[index];
+            HPC_PRINT("%-32s %12.2f %10.2f %12.2f %10d\n"
+                , result.name
+                , result.medianNs
+                , result.madNs
+                , result.minNs
+                , result.iterationCount
+                );
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /// 各処理の結果を、処理の名前をキーとするオブジェクトの配列として出力します。
+    ///
+    /// @param[in] aPath 出力先のファイル名。
+    ///
+    /// @return 出力に成功した場合は @c true を返します。
+    bool Benchmark::writeJson(const char* aPath)const
+    {
+        std::FILE* file = std::fopen(aPath, "wb");
+        if (!file) {
+            return false;
+        }
+        {
+            JsonWriter writer(file, false);
+            writer.write("[\n");
+            for (int index = 0; index < mResultCount; ++index) {
+                const Result& result = mResults[index];
+                writer.write("    {\"name\": \"");
+                writer.write(result.name);
+                writer.write("\", \"iterations\": ");
+                writer.writeInt(result.iterationCount);
+                writer.write(", \"repeats\": ");
+                writer.writeInt(result.repeatCount);
+                writer.write(", \"median_ns\": ");
+                writer.writeFixed(static_cast<float>(result.medianNs), 0, 3);
+                writer.write(", \"mad_ns\": ");
+                writer.writeFixed(static_cast<float>(result.madNs), 0, 3);
+                writer.write(", \"min_ns\": ");
+                writer.writeFixed(static_cast<float>(result.minNs), 0, 3);
+                writer.write(index + 1 < mResultCount ? "},\n" : "}\n");
+            }
+            writer.write("]\n");
+            writer.flush();
+        }
+        const bool isSucceeded = !std::ferror(file);
+        return std::fclose(file) == 0 && isSucceeded;
+    }
+
+    //------------------------------------------------------------------------------
+    /// 計測する処理の結果をこの関数に渡すと、処理が最適化で取り除かれなくなります。
+    ///
+    /// @param[in] aValue 計算結果。
+    void Benchmark::Consume(float aValue)
+    {
+        sConsumed = sConsumed + aValue;
+    }
+}
+
+//------------------------------------------------------------------------------
+// EOF
@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+/// @file
+/// @brief    Benchmark クラス
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2014 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください
+
+//------------------------------------------------------------------------------
+#pragma once
+
+namespace hpc {
+
+    //------------------------------------------------------------------------------
+    /// 処理を繰り返し実行して、1回あたりの時間を計測します。
+    ///
+    /// 各計測は、ウォームアップの後に同じ回数の繰り返しを何度か計測し、
+    /// 1回あたりの時間の中央値と中央絶対偏差 (MAD) を求めます。
+    /// 平均ではなく中央値を使うので、割り込みなどで一部の計測が遅くなっても
+    /// 結果がぶれにくくなります。
+    class Benchmark
+    {
+    public:
+        static const int CaseCountMax = 32;                 ///< 計測できる処理の最大数
+        static const int RepeatCountMax = 99;               ///< 1つの処理を計測する最大回数
+
+        /// 計測する処理の型
+        ///
+        /// @param[in] aUserData       run に渡されたユーザーデータ。
+        /// @param[in] aIterationCount 処理を繰り返す回数。
+        typedef void (*CaseFunc)(void* aUserData, int aIterationCount);
+        /// 計測の前に毎回呼ばれる準備処理の型。この処理の時間は計測しません。
+        typedef void (*SetupFunc)(void* aUserData);
+
+        /// 1つの処理の計測結果
+        struct Result
+        {
+            const char* name;               ///< 処理の名前
+            int iterationCount;             ///< 1回の計測で処理を繰り返した回数
+            int repeatCount;                ///< 計測した回数
+            double medianNs;                ///< 1回あたりの時間の中央値 (ナノ秒)
+            double madNs;                   ///< 1回あたりの時間の中央絶対偏差 (ナノ秒)
+            double minNs;                   ///< 1回あたりの時間の最小値 (ナノ秒)
+        };
+
+        Benchmark();
+
+        void setWarmupCount(int aWarmupCount);              ///< 計測前に空実行する回数を設定します。
+        void setRepeatCount(int aRepeatCount);              ///< 1つの処理を計測する回数を設定します。
+        /// 処理を計測して結果を追加します。
+        void run(
+            const char* aName
+            , CaseFunc aFunc
+            , SetupFunc aSetupFunc
+            , void* aUserData
+            , int aIterationCount
+            );
+
+        int resultCount()const;                             ///< 計測した処理の数を返します。
+        const Result& result(int aIndex)const;              ///< 計測結果を返します。
+        void print()const;                                  ///< 計測結果を表形式で表示します。
+        bool writeJson(const char* aPath)const;             ///< 計測結果を JSON でファイルに出力します。
+
+        static void Consume(float aValue);                  ///< 計算結果が最適化で消されないようにします。
+
+    private:
+        Result mResults[CaseCountMax];                      ///< 計測結果
+        int mResultCount;                                   ///< 計測した処理の数
+        int mWarmupCount;                                   ///< 計測前に空実行する回数
+        int mRepeatCount;                                   ///< 1つの処理を計測する回数
+    };
+}
+//------------------------------------------------------------------------------
+// EOF
@@ -1,6 +1,16 @@
-make clean
-make all
-echo j | make run > output.json
-sed -i -e "1,4d" output.json
-sed -i -e "s/\[d\]ebug \| output \[j\]son \| \[e\]xit: //g" output.json
-python score.py
+# 複数のシードで実行し、基準の得点と比べて得点が下がっていないかを調べる。
+# 使い方: sh test.sh [SEEDS] (SEEDS の既定値は 0-9)
+# 基準の得点ファイルがなければ、今回の得点を基準として保存する。
+# 得点が有意に下がっていれば 1 、実行や比較に失敗すれば 2 で終了する。
+seeds=${1:-0-9}
+make all || exit 2
+mkdir -p scores
+rm -f scores/candidate.txt
+./hpc2014.exe -b "$seeds" -S scores/candidate.txt > /dev/null || exit 2
+[ -s scores/candidate.txt ] || exit 2
+if [ ! -f scores/baseline.txt ]; then
+    cp scores/candidate.txt scores/baseline.txt
+    echo "Saved scores/baseline.txt"
+    exit 0
+fi
+./hpc2014.exe -c scores/baseline.txt scores/candidate.txt